@@ -4,7 +4,28 @@ x86_64-w64-mingw32-gcc \
 -I"./include" \
 -o bin/main \
 src/main.c \
+src/record.c \
+src/capture.c \
+src/onset.c \
+src/tempo.c \
+src/loudness.c \
+src/chroma.c \
+src/fft.c \
+src/fft_fixed.c \
+src/fft_backend.c \
+src/pitch.c \
+src/bench.c \
+src/normalize.c \
+src/shm_publish.c \
+src/stream_server.c \
+src/osc.c \
+src/spectrogram.c \
+src/cache.c \
+src/wav.c \
+src/decoder.c \
+src/resample.c \
 -L./lib \
 -l:libraylib.a \
 -lwinmm -lgdi32 \
+-lpthread \
 -lm
@@ -0,0 +1,347 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "bench.h"
+#include "pitch.h"
+#include "fft_backend.h"
+#include "fft_fixed.h"
+
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static float cents(float f, float reference) {
+    return f > 0 ? 1200.0f * log2f(f / reference) : INFINITY;
+}
+
+//
+// pitch: FFT autocorrelation YIN against the direct difference function
+//
+static int bench_pitch(void) {
+    static PitchTracker fast;
+    static PitchTracker naive;
+    static float signal[PITCH_WINDOW];
+    const unsigned int rate = 44100;
+    const float freqs[] = { 55.0f, 110.0f, 220.0f, 440.0f, 880.0f, 1760.0f };
+    const char *shapes[] = { "sine", "saw" };
+    const int runs = 50;
+    if (!pitch_init(&fast)) return 1;
+
+    printf("%-6s %8s %12s %12s %12s %12s %10s\n",
+           "shape", "f0", "fft cents", "naive cents", "fft us", "naive us", "max diff");
+
+    double fast_total = 0.0;
+    double naive_total = 0.0;
+    srand(1);
+    for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); ++s) {
+        for (size_t f = 0; f < sizeof(freqs) / sizeof(freqs[0]); ++f) {
+            for (size_t i = 0; i < PITCH_WINDOW; ++i) {
+                float phase = 2 * (float) M_PI * freqs[f] * i / rate;
+                float v = 0.0f;
+                if (s == 0) {
+                    v = sinf(phase);
+                } else {
+                    for (int h = 1; h <= 10 && freqs[f] * h < rate / 2; ++h) v += sinf(phase * h) / h;
+                }
+                signal[i] = 0.5f * v + 0.01f * ((float) rand() / RAND_MAX - 0.5f);
+            }
+
+            double start = now();
+            for (int r = 0; r < runs; ++r) pitch_update(&fast, signal, PITCH_WINDOW, 0, rate);
+            double fast_time = (now() - start) / runs;
+
+            start = now();
+            for (int r = 0; r < runs / 10; ++r) pitch_update_naive(&naive, signal, PITCH_WINDOW, 0, rate);
+            double naive_time = (now() - start) / (runs / 10);
+
+            // both leave the normalised difference function behind
+            float max_diff = 0.0f;
+            for (size_t tau = 0; tau < PITCH_WINDOW / 2; ++tau) {
+                max_diff = fmaxf(max_diff, fabsf(fast.diff[tau] - naive.diff[tau]));
+            }
+
+            printf("%-6s %8.1f %12.2f %12.2f %12.1f %12.1f %10.2e\n",
+                   shapes[s], freqs[f], cents(fast.f0, freqs[f]), cents(naive.f0, freqs[f]),
+                   fast_time * 1e6, naive_time * 1e6, max_diff);
+            fast_total += fast_time;
+            naive_total += naive_time;
+        }
+    }
+    printf("speedup %.1fx\n", naive_total / fast_total);
+    pitch_free(&fast);
+    return 0;
+}
+
+//
+// FFT backends, as the suites below see them
+//
+typedef struct {
+    const char *name;
+    // checked at sizes that are not powers of two too; radix2 and split
+    // plan those the same way radix4 does
+    bool other_sizes;
+    // timed by the kernels suite
+    bool timed;
+    // largest error, relative to the reference's largest bin, the backend may make
+    double tolerance;
+} FftCheck;
+
+static const FftCheck fft_checks[] = {
+    { "recursive", false, false, 1e-5 },
+    { "radix2", false, true, 1e-5 },
+    { "split", false, true, 1e-5 },
+    { "fixed", false, false, 2e-2 },
+};
+// radix4 and the external libraries
+static const FftCheck default_check = { NULL, true, true, 1e-5 };
+
+static const FftCheck *check_of(const FftBackend *backend) {
+    for (size_t i = 0; i < sizeof(fft_checks) / sizeof(fft_checks[0]); ++i) {
+        if (strcmp(fft_checks[i].name, backend->name) == 0) return &fft_checks[i];
+    }
+    return &default_check;
+}
+
+// Seconds per transform, the best of a few batches of enough runs to take
+// a few milliseconds.
+static double backend_time(const FftBackend *backend, void *plan, float *signal, Float_Complex *out, size_t n) {
+    int runs = (int) ((1 << 16) / n) + 2;
+    double best = INFINITY;
+    // once untimed, to fault the tables in
+    backend->execute(plan, signal, 1, out);
+    for (int batch = 0; batch < 5; ++batch) {
+        double start = now();
+        for (int r = 0; r < runs; ++r) backend->execute(plan, signal, 1, out);
+        best = fmin(best, (now() - start) / runs);
+    }
+    return best;
+}
+
+//
+// fixed: the 16 bit fixed point FFT against the default float plan
+//
+static int bench_fixed(void) {
+    const FftBackend *floating = fft_backend_find("float");
+    const FftBackend *fixed_point = &fft_backend_fixed;
+    static float signal[FFT_FIXED_MAX_SIZE];
+    static Float_Complex reference[FFT_FIXED_MAX_SIZE];
+    static Float_Complex fixed[FFT_FIXED_MAX_SIZE];
+    const size_t sizes[] = { 1024, 4096, 8192, 16384 };
+    // white noise at full scale and at -60 dB, and a few partials over a hann window
+    const char *signals[] = { "noise", "quiet", "tones" };
+
+    printf("%-6s %6s %10s %12s %12s %8s\n", "signal", "n", "snr dB", "float us", "fixed us", "speedup");
+    srand(1);
+    for (size_t g = 0; g < sizeof(signals) / sizeof(signals[0]); ++g) {
+        for (size_t z = 0; z < sizeof(sizes) / sizeof(sizes[0]); ++z) {
+            size_t n = sizes[z];
+            for (size_t i = 0; i < n; ++i) {
+                float noise = 2.0f * rand() / RAND_MAX - 1.0f;
+                float hann = 0.5f - 0.5f * cosf(2 * (float) M_PI * i / (n - 1));
+                float tones = 0.5f * sinf(2 * (float) M_PI * 440.0f * i / 44100)
+                            + 0.1f * sinf(2 * (float) M_PI * 1234.5f * i / 44100)
+                            + 0.001f * sinf(2 * (float) M_PI * 9876.5f * i / 44100);
+                signal[i] = g == 0 ? noise : g == 1 ? 1e-3f * noise : tones * hann;
+            }
+
+            void *float_plan = floating->create(n);
+            void *fixed_plan = fixed_point->create(n);
+            if (float_plan == NULL || fixed_plan == NULL) return 1;
+            floating->execute(float_plan, signal, 1, reference);
+            fixed_point->execute(fixed_plan, signal, 1, fixed);
+            double power = 0.0;
+            double error = 0.0;
+            for (size_t k = 0; k < n; ++k) {
+                power += crealf(reference[k] * conjf(reference[k]));
+                Float_Complex e = fixed[k] - reference[k];
+                error += crealf(e * conjf(e));
+            }
+
+            double float_time = backend_time(floating, float_plan, signal, reference, n);
+            double fixed_time = backend_time(fixed_point, fixed_plan, signal, fixed, n);
+            floating->destroy(float_plan);
+            fixed_point->destroy(fixed_plan);
+            printf("%-6s %6zu %10.1f %12.1f %12.1f %7.1fx\n", signals[g], n, 10 * log10(power / error),
+                   float_time * 1e6, fixed_time * 1e6, float_time / fixed_time);
+        }
+    }
+    return 0;
+}
+
+//
+// fft: every FFT backend against a double precision DFT
+//
+// Naive DFT, angles taken from a table of n so that no error accumulates.
+static void reference_dft(const float *in, double complex *out, double complex *roots, size_t n) {
+    for (size_t k = 0; k < n; ++k) roots[k] = cexp(-2 * M_PI * I * k / n);
+    for (size_t k = 0; k < n; ++k) {
+        double complex sum = 0.0;
+        size_t j = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += in[i] * roots[j];
+            j += k;
+            if (j >= n) j -= n;
+        }
+        out[k] = sum;
+    }
+}
+
+static int bench_fft(void) {
+    enum { MIN_SIZE = 16, MAX_SIZE = 1 << 16 };
+    // mixed radix ones, among them 100 ms and 1 s at 44.1 and 48 kHz, then
+    // ones with a prime factor above 7 for Bluestein
+    const size_t other_sizes[] = { 6, 12, 100, 441, 1000, 4410, 4800, 6000, 44100,
+                                   17, 22, 97, 1009, 4409, 8191 };
+    size_t sizes[64];
+    size_t size_count = 0;
+    for (size_t n = MIN_SIZE; n <= MAX_SIZE; n *= 2) sizes[size_count++] = n;
+    for (size_t i = 0; i < sizeof(other_sizes) / sizeof(other_sizes[0]); ++i) sizes[size_count++] = other_sizes[i];
+    const char *inputs[] = { "random", "impulse", "sine" };
+    float *signal = malloc(sizeof(float) * MAX_SIZE);
+    Float_Complex *out = malloc(sizeof(Float_Complex) * MAX_SIZE);
+    double complex *reference = malloc(sizeof(double complex) * MAX_SIZE);
+    double complex *roots = malloc(sizeof(double complex) * MAX_SIZE);
+    if (signal == NULL || out == NULL || reference == NULL || roots == NULL) return 1;
+
+    printf("%-10s %-8s %6s %12s %12s %12s %6s\n", "backend", "input", "n", "max error", "rms error", "ns", "");
+    int failures = 0;
+    srand(1);
+    for (size_t z = 0; z < size_count; ++z) {
+        size_t n = sizes[z];
+        bool power_of_two = (n & (n - 1)) == 0;
+        for (size_t g = 0; g < sizeof(inputs) / sizeof(inputs[0]); ++g) {
+            for (size_t i = 0; i < n; ++i) {
+                if (g == 0) signal[i] = 2.0f * rand() / RAND_MAX - 1.0f;
+                if (g == 1) signal[i] = i == 1 ? 1.0f : 0.0f;
+                // between two bins, so that it leaks into all of them
+                if (g == 2) signal[i] = cosf(2 * (float) M_PI * (n / 7 + 0.25f) * i / n);
+            }
+            reference_dft(signal, reference, roots, n);
+            double peak = 0.0;
+            for (size_t k = 0; k < n; ++k) peak = fmax(peak, cabs(reference[k]));
+
+            for (size_t b = 0; fft_backends[b] != NULL; ++b) {
+                const FftBackend *backend = fft_backends[b];
+                const FftCheck *check = check_of(backend);
+                if (!power_of_two && !check->other_sizes) continue;
+                // sizes the backend cannot do are skipped
+                void *plan = backend->create(n);
+                if (plan == NULL) continue;
+                backend->execute(plan, signal, 1, out);
+                double max_error = 0.0;
+                double error = 0.0;
+                for (size_t k = 0; k < n; ++k) {
+                    double d = cabs(out[k] - reference[k]);
+                    max_error = fmax(max_error, d);
+                    error += d * d;
+                }
+                max_error /= peak;
+                error = sqrt(error / n) / peak;
+
+                double time = backend_time(backend, plan, signal, out, n);
+                backend->destroy(plan);
+
+                bool ok = max_error <= check->tolerance;
+                if (!ok) failures++;
+                printf("%-10s %-8s %6zu %12.2e %12.2e %12.0f %6s\n", backend->name, inputs[g], n, max_error,
+                       error, time * 1e9, ok ? "" : "FAIL");
+            }
+        }
+    }
+    printf("errors relative to the largest bin; %d over tolerance\n", failures);
+    free(signal);
+    free(out);
+    free(reference);
+    free(roots);
+    return failures == 0 ? 0 : 1;
+}
+
+//
+// kernels: time per transform of every float backend, against radix-2
+//
+static int bench_kernels(void) {
+    enum { MIN_SIZE = 256, MAX_SIZE = 1 << 16 };
+    float *signal = malloc(sizeof(float) * MAX_SIZE);
+    Float_Complex *out = malloc(sizeof(Float_Complex) * MAX_SIZE);
+    if (signal == NULL || out == NULL) return 1;
+    srand(1);
+    for (size_t i = 0; i < MAX_SIZE; ++i) signal[i] = 2.0f * rand() / RAND_MAX - 1.0f;
+
+    printf("%6s", "n");
+    for (size_t b = 0; fft_backends[b] != NULL; ++b) {
+        if (check_of(fft_backends[b])->timed) printf(" %10s us", fft_backends[b]->name);
+    }
+    printf("  speedup over radix2\n");
+    for (size_t n = MIN_SIZE; n <= MAX_SIZE; n *= 2) {
+        printf("%6zu", n);
+        double base = 0.0;
+        char speedups[128] = "";
+        size_t used = 0;
+        for (size_t b = 0; fft_backends[b] != NULL; ++b) {
+            const FftBackend *backend = fft_backends[b];
+            if (!check_of(backend)->timed) continue;
+            void *plan = backend->create(n);
+            if (plan == NULL) {
+                printf(" %13s", "-");
+                continue;
+            }
+            double time = backend_time(backend, plan, signal, out, n);
+            backend->destroy(plan);
+            printf(" %13.1f", time * 1e6);
+            if (backend == &fft_backend_radix2) {
+                base = time;
+            } else if (used < sizeof(speedups)) {
+                used += snprintf(speedups + used, sizeof(speedups) - used, " %5.2fx", base / time);
+            }
+        }
+        printf(" %s\n", speedups);
+    }
+
+    // window lengths of whole durations, against radix2 at the power of two above
+    const size_t other_sizes[] = { 4410, 4800, 6000, 44100, 48000, 4409, 8191 };
+    printf("\n%6s", "n");
+    for (size_t b = 0; fft_backends[b] != NULL; ++b) {
+        const FftCheck *check = check_of(fft_backends[b]);
+        if (check->timed && check->other_sizes) printf(" %10s us", fft_backends[b]->name);
+    }
+    printf(" %10s %13s\n", "radix2 at", "us");
+    for (size_t i = 0; i < sizeof(other_sizes) / sizeof(other_sizes[0]); ++i) {
+        size_t n = other_sizes[i];
+        printf("%6zu", n);
+        for (size_t b = 0; fft_backends[b] != NULL; ++b) {
+            const FftBackend *backend = fft_backends[b];
+            const FftCheck *check = check_of(backend);
+            if (!check->timed || !check->other_sizes) continue;
+            void *plan = backend->create(n);
+            if (plan == NULL) {
+                printf(" %13s", "-");
+                continue;
+            }
+            printf(" %13.1f", backend_time(backend, plan, signal, out, n) * 1e6);
+            backend->destroy(plan);
+        }
+        size_t above = 1;
+        while (above < n) above *= 2;
+        void *plan = fft_backend_radix2.create(above);
+        if (plan == NULL) return 1;
+        printf(" %10zu %13.1f\n", above, backend_time(&fft_backend_radix2, plan, signal, out, above) * 1e6);
+        fft_backend_radix2.destroy(plan);
+    }
+    free(signal);
+    free(out);
+    return 0;
+}
+
+int bench_run(const char *suite) {
+    if (strcmp(suite, "pitch") == 0) return bench_pitch();
+    if (strcmp(suite, "fixed") == 0) return bench_fixed();
+    if (strcmp(suite, "fft") == 0) return bench_fft();
+    if (strcmp(suite, "kernels") == 0) return bench_kernels();
+    fprintf(stderr, "unknown benchmark %s, available: pitch, fixed, fft, kernels\n", suite);
+    return 1;
+}
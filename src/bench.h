@@ -0,0 +1,8 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// Runs the named benchmark suite and prints a report to stdout, returns the
+// process exit status. Needs no window or audio device.
+int bench_run(const char *suite);
+
+#endif // BENCH_H
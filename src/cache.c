@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <time.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include <raylib.h>
+#include "cache.h"
+
+#define FNV_OFFSET 0xcbf29ce484222325ull
+#define FNV_PRIME 0x100000001b3ull
+
+static uint64_t hash_bytes(uint64_t h, const unsigned char *p, size_t n) {
+    for (size_t i = 0; i < n; ++i) h = (h ^ p[i]) * FNV_PRIME;
+    return h;
+}
+
+static bool hash_file(const char *path, uint64_t *h) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return false;
+    static unsigned char block[1 << 16];
+    size_t n;
+    while ((n = fread(block, 1, sizeof(block), file)) > 0) *h = hash_bytes(*h, block, n);
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+static bool make_dir(const char *dir) {
+#ifdef _WIN32
+    int result = mkdir(dir);
+#else
+    int result = mkdir(dir, 0755);
+#endif
+    return result == 0 || errno == EEXIST;
+}
+
+// room for the directory and any file name in it
+typedef char CachePath[CACHE_PATH_MAX + 256];
+
+static void stats_path(const SpectrumCache *c, CachePath out) {
+    snprintf(out, sizeof(CachePath), "%s/stats", c->dir);
+}
+
+bool cache_open(SpectrumCache *c, const char *dir, uint64_t budget, const char *input, const char *params) {
+    memset(c, 0, sizeof(*c));
+    c->budget = budget;
+    c->opened = time(NULL);
+    if (strlen(dir) >= CACHE_PATH_MAX) {
+        TraceLog(LOG_ERROR, "CACHE: Directory path %s is too long", dir);
+        return false;
+    }
+    strcpy(c->dir, dir);
+    if (!make_dir(dir)) {
+        TraceLog(LOG_ERROR, "CACHE: Could not create %s", dir);
+        return false;
+    }
+
+    uint64_t h = FNV_OFFSET;
+    if (!hash_file(input, &h)) {
+        TraceLog(LOG_ERROR, "CACHE: Could not read %s", input);
+        return false;
+    }
+    c->key = hash_bytes(h, (const unsigned char *) params, strlen(params));
+    snprintf(c->entry, sizeof(c->entry), "%s/%016llx.spg", dir, (unsigned long long) c->key);
+    snprintf(c->partial, sizeof(c->partial), "%s/%016llx.partial", dir, (unsigned long long) c->key);
+
+    CachePath path;
+    stats_path(c, path);
+    FILE *stats = fopen(path, "r");
+    if (stats != NULL) {
+        unsigned long long hits, misses, evictions;
+        if (fscanf(stats, "%llu %llu %llu", &hits, &misses, &evictions) == 3) {
+            c->hits = hits;
+            c->misses = misses;
+            c->evictions = evictions;
+        }
+        fclose(stats);
+    }
+    return true;
+}
+
+bool cache_lookup(SpectrumCache *c, Spectrogram *s, unsigned int sample_rate, unsigned int fft_size,
+                  unsigned int frame_rate) {
+    if (!spectrogram_open(s, c->entry)) {
+        c->misses++;
+        return false;
+    }
+    const SpectrogramHeader *h = s->header;
+    if (s->index == NULL || s->count == 0) {
+        // not written by cache_commit, do not trust it
+        spectrogram_close(s);
+        remove(c->entry);
+        c->misses++;
+        return false;
+    }
+    if (h->sample_rate != sample_rate || h->fft_size != fft_size || h->frame_rate != frame_rate
+        || h->bands >= fft_size) {
+        // analysed some other way, a run that fills the cache replaces it
+        TraceLog(LOG_INFO, "CACHE: Dropping stale %s", c->entry);
+        spectrogram_close(s);
+        remove(c->entry);
+        c->misses++;
+        return false;
+    }
+    // eviction goes by modification time
+    utime(c->entry, NULL);
+    c->hits++;
+    TraceLog(LOG_INFO, "CACHE: Replaying %s (%zu frames)", c->entry, s->count);
+    return true;
+}
+
+typedef struct {
+    char name[256];
+    uint64_t size;
+    time_t used;
+} CacheEntry;
+
+static int by_use(const void *a, const void *b) {
+    time_t x = ((const CacheEntry *) a)->used;
+    time_t y = ((const CacheEntry *) b)->used;
+    return (x > y) - (x < y);
+}
+
+static void evict(SpectrumCache *c) {
+    DIR *dir = opendir(c->dir);
+    if (dir == NULL) return;
+
+    CacheEntry *entries = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    uint64_t total = 0;
+    struct dirent *d;
+    while ((d = readdir(dir)) != NULL) {
+        size_t length = strlen(d->d_name);
+        CachePath path;
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/%s", c->dir, d->d_name);
+        // left by a run that died before committing it; one still being
+        // written by another run has been touched since this one started
+        if (length > 8 && strcmp(d->d_name + length - 8, ".partial") == 0) {
+            if (stat(path, &st) == 0 && st.st_mtime < c->opened && remove(path) == 0) {
+                TraceLog(LOG_INFO, "CACHE: Removed stale %s", path);
+            }
+            continue;
+        }
+        if (length < 4 || length >= sizeof(entries->name) || strcmp(d->d_name + length - 4, ".spg") != 0) continue;
+        if (stat(path, &st) != 0) continue;
+
+        if (count == capacity) {
+            capacity = capacity ? 2 * capacity : 64;
+            CacheEntry *grown = realloc(entries, capacity * sizeof(CacheEntry));
+            if (grown == NULL) break;
+            entries = grown;
+        }
+        strcpy(entries[count].name, d->d_name);
+        entries[count].size = st.st_size;
+        entries[count].used = st.st_mtime;
+        total += st.st_size;
+        count++;
+    }
+    closedir(dir);
+
+    qsort(entries, count, sizeof(CacheEntry), by_use);
+    const char *current = strrchr(c->entry, '/') + 1;
+    for (size_t i = 0; i < count && total > c->budget; ++i) {
+        if (strcmp(entries[i].name, current) == 0) continue;
+        CachePath path;
+        snprintf(path, sizeof(path), "%s/%s", c->dir, entries[i].name);
+        if (remove(path) == 0) {
+            total -= entries[i].size;
+            c->evictions++;
+        }
+    }
+    free(entries);
+}
+
+bool cache_commit(SpectrumCache *c) {
+#ifdef _WIN32
+    // rename does not replace on Windows
+    remove(c->entry);
+#endif
+    if (rename(c->partial, c->entry) != 0) {
+        TraceLog(LOG_ERROR, "CACHE: Could not store %s", c->entry);
+        remove(c->partial);
+        return false;
+    }
+    TraceLog(LOG_INFO, "CACHE: Stored %s", c->entry);
+    evict(c);
+    return true;
+}
+
+void cache_discard(SpectrumCache *c) {
+    remove(c->partial);
+}
+
+void cache_close(SpectrumCache *c) {
+    CachePath path;
+    stats_path(c, path);
+    FILE *stats = fopen(path, "w");
+    if (stats != NULL) {
+        fprintf(stats, "%llu %llu %llu\n", (unsigned long long) c->hits, (unsigned long long) c->misses,
+                (unsigned long long) c->evictions);
+        fclose(stats);
+    }
+    uint64_t lookups = c->hits + c->misses;
+    TraceLog(LOG_INFO, "CACHE: %llu hits, %llu misses (%.0f%% hit rate), %llu evicted",
+             (unsigned long long) c->hits, (unsigned long long) c->misses,
+             lookups ? 100.0 * c->hits / lookups : 0.0, (unsigned long long) c->evictions);
+}
@@ -0,0 +1,46 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "spectrogram.h"
+
+#define CACHE_DEFAULT_BUDGET ((uint64_t) 256 << 20)
+#define CACHE_PATH_MAX 1024
+
+// On-disk cache of analysed inputs. Every entry is a spectrogram file named
+// by a 64 bit hash of the input file's bytes and the analysis parameters,
+// so any change to either is a different entry. Entries are written by
+// the offline modes and stand in for the analysis on later runs. The least
+// recently used entries are evicted when the directory grows past budget.
+typedef struct {
+    char dir[CACHE_PATH_MAX];
+    char entry[CACHE_PATH_MAX + 32];
+    char partial[CACHE_PATH_MAX + 32]; // entry while it is being written
+    uint64_t budget;
+    uint64_t key;
+    time_t opened; // partial entries older than this are left by dead runs
+
+    // kept across runs in dir/stats
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+} SpectrumCache;
+
+// Creates dir if needed and hashes input together with params, a string
+// naming everything else the analysis output depends on.
+bool cache_open(SpectrumCache *c, const char *dir, uint64_t budget, const char *input, const char *params);
+// Maps the entry on a hit and marks it as recently used. An entry analysed
+// at another sample rate, FFT size or frame rate is removed and a miss.
+bool cache_lookup(SpectrumCache *c, Spectrogram *s, unsigned int sample_rate, unsigned int fft_size,
+                  unsigned int frame_rate);
+// Moves a complete spectrogram written to c->partial into place, then
+// evicts down to the budget and removes partial entries left by dead runs.
+bool cache_commit(SpectrumCache *c);
+void cache_discard(SpectrumCache *c);
+// Saves the stats and logs the hit rate.
+void cache_close(SpectrumCache *c);
+
+#endif // CACHE_H
@@ -0,0 +1,228 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <raylib.h>
+#include <rlgl.h>
+#include "capture.h"
+
+// raylib keeps its GL loader private, ask GLFW (linked into raylib) for the
+// few entry points rlgl does not wrap.
+typedef void (*GLproc)(void);
+extern GLproc glfwGetProcAddress(const char *procname);
+
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#define GL_STREAM_READ 0x88E1
+#define GL_MAP_READ_BIT 0x0001
+#define GL_RGBA 0x1908
+#define GL_UNSIGNED_BYTE 0x1401
+#define GL_PACK_ALIGNMENT 0x0D05
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#define GL_TIMEOUT_EXPIRED 0x911B
+#define GL_WAIT_FAILED 0x911D
+
+static struct {
+    void (*GenBuffers)(int n, unsigned int *buffers);
+    void (*DeleteBuffers)(int n, const unsigned int *buffers);
+    void (*BindBuffer)(unsigned int target, unsigned int buffer);
+    void (*BufferData)(unsigned int target, ptrdiff_t size, const void *data, unsigned int usage);
+    void *(*MapBufferRange)(unsigned int target, ptrdiff_t offset, ptrdiff_t length, unsigned int access);
+    unsigned char (*UnmapBuffer)(unsigned int target);
+    void (*ReadPixels)(int x, int y, int width, int height, unsigned int format, unsigned int type, void *pixels);
+    void (*PixelStorei)(unsigned int pname, int param);
+    void *(*FenceSync)(unsigned int condition, unsigned int flags);
+    unsigned int (*ClientWaitSync)(void *sync, unsigned int flags, uint64_t timeout);
+    void (*DeleteSync)(void *sync);
+} gl;
+
+static bool load_gl(void) {
+    gl.ReadPixels = (void *) glfwGetProcAddress("glReadPixels");
+    gl.PixelStorei = (void *) glfwGetProcAddress("glPixelStorei");
+    gl.GenBuffers = (void *) glfwGetProcAddress("glGenBuffers");
+    gl.DeleteBuffers = (void *) glfwGetProcAddress("glDeleteBuffers");
+    gl.BindBuffer = (void *) glfwGetProcAddress("glBindBuffer");
+    gl.BufferData = (void *) glfwGetProcAddress("glBufferData");
+    gl.MapBufferRange = (void *) glfwGetProcAddress("glMapBufferRange");
+    gl.UnmapBuffer = (void *) glfwGetProcAddress("glUnmapBuffer");
+    gl.FenceSync = (void *) glfwGetProcAddress("glFenceSync");
+    gl.ClientWaitSync = (void *) glfwGetProcAddress("glClientWaitSync");
+    gl.DeleteSync = (void *) glfwGetProcAddress("glDeleteSync");
+    return gl.GenBuffers && gl.DeleteBuffers && gl.BindBuffer && gl.BufferData && gl.MapBufferRange
+           && gl.UnmapBuffer && gl.FenceSync && gl.ClientWaitSync && gl.DeleteSync;
+}
+
+static void *writer(void *arg) {
+    Capture *c = arg;
+    pthread_mutex_lock(&c->lock);
+    for (;;) {
+        while (c->written == c->queued && !c->closing) pthread_cond_wait(&c->cond, &c->lock);
+        if (c->written == c->queued) break;
+
+        unsigned char *frame = c->queue[c->written % CAPTURE_QUEUE];
+        pthread_mutex_unlock(&c->lock);
+        bool ok = recorder_write(c->recorder, frame);
+        pthread_mutex_lock(&c->lock);
+
+        if (!ok) c->failed = true;
+        c->written++;
+        pthread_cond_signal(&c->cond);
+    }
+    pthread_mutex_unlock(&c->lock);
+    return NULL;
+}
+
+// Waits for a free queue slot, returns NULL once the writer has failed.
+static unsigned char *acquire(Capture *c) {
+    double start = GetTime();
+    pthread_mutex_lock(&c->lock);
+    while (c->queued - c->written == CAPTURE_QUEUE && !c->failed) pthread_cond_wait(&c->cond, &c->lock);
+    unsigned char *frame = c->failed ? NULL : c->queue[c->queued % CAPTURE_QUEUE];
+    pthread_mutex_unlock(&c->lock);
+    c->stall_writer += GetTime() - start;
+    return frame;
+}
+
+static void submit(Capture *c) {
+    pthread_mutex_lock(&c->lock);
+    c->queued++;
+    pthread_cond_signal(&c->cond);
+    pthread_mutex_unlock(&c->lock);
+}
+
+// Marks the capture failed from the render thread, so capture_close reports it.
+static bool fail(Capture *c, const char *what) {
+    TraceLog(LOG_ERROR, "CAPTURE: %s", what);
+    pthread_mutex_lock(&c->lock);
+    c->failed = true;
+    pthread_mutex_unlock(&c->lock);
+    return false;
+}
+
+// Copies the oldest in-flight frame out of its PBO and hands it to the writer.
+static bool collect(Capture *c) {
+    size_t slot = c->collected % CAPTURE_RING;
+
+    double start = GetTime();
+    unsigned int status = gl.ClientWaitSync(c->fence[slot], GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_MAX);
+    gl.DeleteSync(c->fence[slot]);
+    c->fence[slot] = NULL;
+    c->stall_gpu += GetTime() - start;
+    if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED) return fail(c, "Waiting for a frame readback failed");
+
+    unsigned char *frame = acquire(c);
+    if (frame == NULL) return false;
+
+    gl.BindBuffer(GL_PIXEL_PACK_BUFFER, c->pbo[slot]);
+    const void *pixels = gl.MapBufferRange(GL_PIXEL_PACK_BUFFER, 0, c->frame_size, GL_MAP_READ_BIT);
+    if (pixels != NULL) {
+        memcpy(frame, pixels, c->frame_size);
+        gl.UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (pixels == NULL) return fail(c, "Mapping a frame readback failed");
+
+    c->collected++;
+    submit(c);
+    return true;
+}
+
+bool capture_init(Capture *c, Recorder *recorder, int width, int height) {
+    *c = (Capture) {
+            .recorder = recorder,
+            .width = width,
+            .height = height,
+            .frame_size = (size_t) width * height * 4,
+    };
+
+    c->use_pbo = load_gl();
+    if (gl.ReadPixels == NULL || gl.PixelStorei == NULL) {
+        TraceLog(LOG_ERROR, "CAPTURE: glReadPixels is not available");
+        return false;
+    }
+    if (!c->use_pbo) TraceLog(LOG_WARNING, "CAPTURE: No pixel buffer object support, reading back synchronously");
+
+    for (size_t i = 0; i < CAPTURE_QUEUE; ++i) {
+        c->queue[i] = malloc(c->frame_size);
+        if (c->queue[i] == NULL) {
+            for (size_t j = 0; j < i; ++j) free(c->queue[j]);
+            return false;
+        }
+    }
+
+    if (c->use_pbo) {
+        gl.GenBuffers(CAPTURE_RING, c->pbo);
+        for (size_t i = 0; i < CAPTURE_RING; ++i) {
+            gl.BindBuffer(GL_PIXEL_PACK_BUFFER, c->pbo[i]);
+            gl.BufferData(GL_PIXEL_PACK_BUFFER, c->frame_size, NULL, GL_STREAM_READ);
+        }
+        gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    gl.PixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_cond_init(&c->cond, NULL);
+    if (pthread_create(&c->thread, NULL, writer, c) != 0) {
+        TraceLog(LOG_ERROR, "CAPTURE: Could not start the writer thread");
+        pthread_cond_destroy(&c->cond);
+        pthread_mutex_destroy(&c->lock);
+        if (c->use_pbo) gl.DeleteBuffers(CAPTURE_RING, c->pbo);
+        for (size_t i = 0; i < CAPTURE_QUEUE; ++i) free(c->queue[i]);
+        return false;
+    }
+    return true;
+}
+
+bool capture_frame(Capture *c, unsigned int fbo) {
+    if (!c->use_pbo) {
+        unsigned char *frame = acquire(c);
+        if (frame == NULL) return false;
+        rlEnableFramebuffer(fbo);
+        gl.ReadPixels(0, 0, c->width, c->height, GL_RGBA, GL_UNSIGNED_BYTE, frame);
+        rlDisableFramebuffer();
+        c->issued++;
+        c->collected++;
+        submit(c);
+        return true;
+    }
+
+    // with every slot in flight, the oldest is collected to take its buffer
+    while (c->issued - c->collected >= CAPTURE_RING) {
+        if (!collect(c)) return false;
+    }
+
+    size_t slot = c->issued % CAPTURE_RING;
+    rlEnableFramebuffer(fbo);
+    gl.BindBuffer(GL_PIXEL_PACK_BUFFER, c->pbo[slot]);
+    gl.ReadPixels(0, 0, c->width, c->height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    rlDisableFramebuffer();
+    c->fence[slot] = gl.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    c->issued++;
+    return true;
+}
+
+bool capture_close(Capture *c) {
+    bool ok = true;
+    while (ok && c->use_pbo && c->collected < c->issued) ok = collect(c);
+
+    pthread_mutex_lock(&c->lock);
+    c->closing = true;
+    pthread_cond_signal(&c->cond);
+    pthread_mutex_unlock(&c->lock);
+    pthread_join(c->thread, NULL);
+    ok = ok && !c->failed;
+
+    if (c->use_pbo) {
+        for (size_t i = 0; i < CAPTURE_RING; ++i) {
+            if (c->fence[i] != NULL) gl.DeleteSync(c->fence[i]);
+        }
+        gl.DeleteBuffers(CAPTURE_RING, c->pbo);
+    }
+    for (size_t i = 0; i < CAPTURE_QUEUE; ++i) free(c->queue[i]);
+    pthread_cond_destroy(&c->cond);
+    pthread_mutex_destroy(&c->lock);
+
+    TraceLog(LOG_INFO, "CAPTURE: %zu frames, %.3fs waiting on the GPU, %.3fs waiting on the writer",
+             c->written, c->stall_gpu, c->stall_writer);
+    return ok;
+}
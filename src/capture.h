@@ -0,0 +1,52 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "record.h"
+
+// Frames in flight on the GPU: frame N is mapped once N + 3 has rendered,
+// just before the readback of N + 3 reuses its buffer.
+#define CAPTURE_RING 3
+// Frames handed to the writer thread that have not been written yet.
+#define CAPTURE_QUEUE 4
+
+// Asynchronous framebuffer readback. glReadPixels goes into a ring of pixel
+// buffer objects so it returns immediately, the buffer is mapped
+// CAPTURE_RING frames later when the transfer is long done, and the
+// conversion and file IO of the Recorder run on a separate thread.
+typedef struct {
+    Recorder *recorder;
+    int width;
+    int height;
+    size_t frame_size;
+    bool use_pbo;
+
+    // render thread
+    unsigned int pbo[CAPTURE_RING];
+    void *fence[CAPTURE_RING];
+    size_t issued;
+    size_t collected;
+    double stall_gpu;
+    double stall_writer;
+
+    // shared with the writer thread, guarded by lock
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    unsigned char *queue[CAPTURE_QUEUE];
+    size_t queued;
+    size_t written;
+    bool closing;
+    bool failed;
+} Capture;
+
+// Must be called with the OpenGL context current.
+bool capture_init(Capture *c, Recorder *recorder, int width, int height);
+// Queues a readback of the color attachment of framebuffer fbo.
+bool capture_frame(Capture *c, unsigned int fbo);
+// Drains every pending frame, stops the writer and releases GPU buffers.
+bool capture_close(Capture *c);
+
+#endif // CAPTURE_H
@@ -0,0 +1,75 @@
+#include <string.h>
+#include <math.h>
+#include "chroma.h"
+
+// Drift that triggers a rebuild of the bin-to-chroma matrix, in semitones.
+#define CHROMA_RETUNE 0.05f
+
+static void build_map(ChromaExtractor *c) {
+    float lo = CHROMA_MIN_FREQ * c->fft_size / c->sample_rate;
+    float hi = CHROMA_MAX_FREQ * c->fft_size / c->sample_rate;
+    float reference = 440.0f * exp2f(c->map_tuning / 12.0f);
+
+    for (size_t q = 0; q < c->bins; ++q) {
+        c->class0[q] = 0;
+        c->class1[q] = 0;
+        c->weight0[q] = 0.0f;
+        c->weight1[q] = 0.0f;
+        if (q < lo || q > hi) continue;
+
+        // MIDI-style pitch, 69 is A4, split linearly between the two
+        // nearest pitch classes
+        float f = (float) q * c->sample_rate / c->fft_size;
+        float pitch = 69.0f + 12.0f * log2f(f / reference);
+        float lower = floorf(pitch);
+        float frac = pitch - lower;
+        int pc = ((int) lower % 12 + 12) % 12;
+        c->class0[q] = (unsigned char) pc;
+        c->class1[q] = (unsigned char) ((pc + 1) % 12);
+        c->weight0[q] = 1.0f - frac;
+        c->weight1[q] = frac;
+    }
+}
+
+void chroma_init(ChromaExtractor *c, unsigned int sample_rate, size_t fft_size) {
+    memset(c, 0, sizeof(*c));
+    c->sample_rate = sample_rate;
+    c->fft_size = fft_size;
+    c->bins = fft_size / 2 < CHROMA_MAX_BINS ? fft_size / 2 : CHROMA_MAX_BINS;
+
+    // phasors are relative to A440, the tuning estimate is their mean angle
+    float lo = CHROMA_MIN_FREQ * fft_size / sample_rate;
+    float hi = CHROMA_MAX_FREQ * fft_size / sample_rate;
+    for (size_t q = 0; q < c->bins; ++q) {
+        if (q < lo || q > hi) continue;
+        float f = (float) q * sample_rate / fft_size;
+        float angle = 2 * (float) M_PI * 12.0f * log2f(f / 440.0f);
+        c->phasor_re[q] = cosf(angle);
+        c->phasor_im[q] = sinf(angle);
+    }
+    build_map(c);
+}
+
+void chroma_finish(ChromaExtractor *c) {
+    float max = 0.0f;
+    for (size_t i = 0; i < 12; ++i) {
+        if (c->acc[i] > max) max = c->acc[i];
+    }
+    for (size_t i = 0; i < 12; ++i) {
+        c->chroma[i] = max > 0 ? c->acc[i] / max : 0.0f;
+    }
+
+    // long running average of the per-frame tuning phasor, normalised so
+    // loud frames do not dominate
+    float norm = hypotf(c->tune_re, c->tune_im);
+    if (norm > 0) {
+        c->tune_avg_re += (c->tune_re / norm - c->tune_avg_re) * 0.01f;
+        c->tune_avg_im += (c->tune_im / norm - c->tune_avg_im) * 0.01f;
+        c->tuning = atan2f(c->tune_avg_im, c->tune_avg_re) / (2 * (float) M_PI);
+    }
+
+    if (fabsf(c->tuning - c->map_tuning) > CHROMA_RETUNE) {
+        c->map_tuning = c->tuning;
+        build_map(c);
+    }
+}
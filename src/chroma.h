@@ -0,0 +1,62 @@
+#ifndef CHROMA_H
+#define CHROMA_H
+
+#include <stddef.h>
+
+#define CHROMA_MAX_BINS (1 << 15)
+// Only bins between these frequencies carry pitch information worth having.
+#define CHROMA_MIN_FREQ 60.0f
+#define CHROMA_MAX_FREQ 5000.0f
+
+// Pitch class profile built from the FFT bins while they are banded. Every
+// bin feeds at most two neighbouring pitch classes, so the bin-to-chroma
+// matrix is stored as two (class, weight) pairs per bin; bins outside the
+// useful range have zero weights and cost nothing to skip.
+typedef struct {
+    unsigned int sample_rate;
+    size_t fft_size;
+    size_t bins;
+
+    unsigned char class0[CHROMA_MAX_BINS];
+    unsigned char class1[CHROMA_MAX_BINS];
+    float weight0[CHROMA_MAX_BINS];
+    float weight1[CHROMA_MAX_BINS];
+    // unit phasor of each bin's pitch, summed to estimate the tuning
+    float phasor_re[CHROMA_MAX_BINS];
+    float phasor_im[CHROMA_MAX_BINS];
+
+    // accumulators of the frame being banded
+    float acc[12];
+    float tune_re;
+    float tune_im;
+
+    // tuning offset from A440 in semitones, and the one the matrix uses
+    float tune_avg_re;
+    float tune_avg_im;
+    float tuning;
+    float map_tuning;
+
+    // latest frame, 0..1 with the strongest class at 1; index 0 is C
+    float chroma[12];
+} ChromaExtractor;
+
+void chroma_init(ChromaExtractor *c, unsigned int sample_rate, size_t fft_size);
+
+static inline void chroma_begin(ChromaExtractor *c) {
+    for (size_t i = 0; i < 12; ++i) c->acc[i] = 0.0f;
+    c->tune_re = 0.0f;
+    c->tune_im = 0.0f;
+}
+
+static inline void chroma_accumulate(ChromaExtractor *c, size_t bin, float power) {
+    c->acc[c->class0[bin]] += c->weight0[bin] * power;
+    c->acc[c->class1[bin]] += c->weight1[bin] * power;
+    c->tune_re += c->phasor_re[bin] * power;
+    c->tune_im += c->phasor_im[bin] * power;
+}
+
+// Normalises the frame and follows the tuning, rebuilding the matrix when
+// it drifts by more than a few cents.
+void chroma_finish(ChromaExtractor *c);
+
+#endif // CHROMA_H
@@ -0,0 +1,367 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include "decoder.h"
+
+#include <unistd.h>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Enough for the chunks in front of the samples of any sane WAV file.
+#define DECODER_HEADER (1 << 16)
+
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// sem_wait that adds the time it had to block to waited.
+static void wait_for(sem_t *sem, double *waited) {
+    if (sem_trywait(sem) == 0) return;
+    double start = now();
+    while (sem_wait(sem) != 0 && errno == EINTR) {}
+    *waited += now() - start;
+}
+
+// Waits until fd has input or the decoder is stopped, false for the latter.
+static bool readable(Decoder *d) {
+#ifndef _WIN32
+    struct pollfd p = { .fd = d->fd, .events = POLLIN };
+    while (!atomic_load_explicit(&d->stop, memory_order_relaxed)) {
+        if (poll(&p, 1, 100) != 0) return true;
+    }
+    return false;
+#else
+    // no poll for pipes, closing waits until the next read returns
+    return !atomic_load_explicit(&d->stop, memory_order_relaxed);
+#endif
+}
+
+// Takes whatever a pipe has, up to a block, but at least a whole frame.
+// A partial frame at the end of a read waits in raw for the next one.
+static size_t fill_stream(Decoder *d, float *block) {
+    size_t capacity = DECODER_BLOCK_FRAMES * d->frame_size;
+    while (d->carry < d->frame_size) {
+        if (!readable(d)) return 0;
+        ssize_t got = read(d->fd, d->raw + d->carry, capacity - d->carry);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return 0;
+        d->carry += got;
+    }
+    size_t n = d->carry / d->frame_size;
+    pcm_to_float(d->raw, d->format, block, n * d->channels);
+    d->carry -= n * d->frame_size;
+    memmove(d->raw, d->raw + n * d->frame_size, d->carry);
+    d->produced += n;
+    return n;
+}
+
+static size_t fill(Decoder *d, float *block) {
+    if (d->stream) return fill_stream(d, block);
+    if (d->loop && d->produced == d->frame_count && d->frame_count > 0) {
+        if (d->file != NULL && fseek(d->file, d->file_start, SEEK_SET) != 0) return 0;
+        d->produced = 0;
+    }
+    size_t n = d->frame_count - d->produced;
+    if (n > DECODER_BLOCK_FRAMES) n = DECODER_BLOCK_FRAMES;
+    const void *src;
+    if (d->file != NULL) {
+        n = fread(d->raw, d->frame_size, n, d->file);
+        src = d->raw;
+    } else {
+        src = (const unsigned char *) d->wave.data + d->produced * d->frame_size;
+    }
+    pcm_to_float(src, d->format, block, n * d->channels);
+    d->produced += n;
+    return n;
+}
+
+static bool load_wave(Decoder *d) {
+    d->wave = LoadWave(d->path);
+    if (d->wave.frameCount == 0) return false;
+    switch (d->wave.sampleSize) {
+        case 8: d->format = PCM_U8; break;
+        case 16: d->format = PCM_S16; break;
+        case 32: d->format = PCM_F32; break;
+        default: return false;
+    }
+    d->sample_rate = d->wave.sampleRate;
+    d->channels = d->wave.channels;
+    d->frame_count = d->wave.frameCount;
+    d->frame_size = d->channels * pcm_sample_size(d->format);
+    d->pool = malloc(sizeof(float) * DECODER_BLOCKS * DECODER_BLOCK_FRAMES * d->channels);
+    return d->pool != NULL;
+}
+
+static void *produce(void *arg) {
+    Decoder *d = arg;
+    if (d->deferred) {
+        bool ok = load_wave(d);
+        if (!ok) {
+            TraceLog(LOG_ERROR, "DECODE: Could not decode %s", d->path);
+            d->sample_rate = 0;
+        }
+        sem_post(&d->loaded);
+        if (!ok) {
+            // an input that ends before it starts
+            d->frames[0] = 0;
+            sem_post(&d->full);
+            return NULL;
+        }
+    }
+    for (size_t head = 0;; ++head) {
+        wait_for(&d->free, &d->producer_wait);
+        if (atomic_load_explicit(&d->stop, memory_order_relaxed)) break;
+        size_t slot = head % DECODER_BLOCKS;
+        size_t n = fill(d, d->pool + slot * DECODER_BLOCK_FRAMES * d->channels);
+        d->frames[slot] = n;
+        sem_post(&d->full);
+        if (n == 0) break;
+    }
+    return NULL;
+}
+
+static void use_info(Decoder *d, const WavInfo *info) {
+    d->sample_rate = info->sample_rate;
+    d->channels = info->channels;
+    d->frame_count = info->frame_count;
+    d->format = info->format;
+    d->frame_size = info->frame_size;
+}
+
+#ifndef _WIN32
+
+static bool open_mapped(Decoder *d, const char *path, const WavInfo *raw) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) return false;
+    d->map = map;
+    d->map_size = st.st_size;
+
+    WavInfo info;
+    if (raw != NULL) {
+        info = *raw;
+        info.frame_count = d->map_size / info.frame_size;
+    } else if (!wav_parse(map, d->map_size, &info) || info.data_offset > d->map_size) {
+        return false;
+    }
+    // a data chunk claiming more than the file holds is cut short
+    uint64_t available = (d->map_size - info.data_offset) / info.frame_size;
+    if (info.frame_count > available) info.frame_count = available;
+    use_info(d, &info);
+    d->data = (const unsigned char *) map + info.data_offset;
+    d->scratch = malloc(sizeof(float) * DECODER_BLOCK_FRAMES * d->channels);
+    madvise(map, d->map_size, MADV_SEQUENTIAL);
+    return d->scratch != NULL;
+}
+
+static void close_mapped(Decoder *d) {
+    if (d->map != NULL) munmap(d->map, d->map_size);
+}
+
+#else
+
+static bool open_mapped(Decoder *d, const char *path, const WavInfo *raw) {
+    (void) d;
+    (void) path;
+    (void) raw;
+    return false;
+}
+
+static void close_mapped(Decoder *d) {
+    (void) d;
+}
+
+#endif
+
+static bool open_file(Decoder *d, const char *path, const WavInfo *raw) {
+    d->file = fopen(path, "rb");
+    if (d->file == NULL) return false;
+    WavInfo info;
+    bool ok;
+    if (raw != NULL) {
+        info = *raw;
+        ok = fseek(d->file, 0, SEEK_END) == 0 && ftell(d->file) >= 0;
+        if (ok) info.frame_count = (size_t) ftell(d->file) / info.frame_size;
+        ok = ok && fseek(d->file, 0, SEEK_SET) == 0;
+    } else {
+        unsigned char *header = malloc(DECODER_HEADER);
+        ok = header != NULL && wav_parse(header, fread(header, 1, DECODER_HEADER, d->file), &info)
+             && fseek(d->file, (long) info.data_offset, SEEK_SET) == 0;
+        free(header);
+    }
+    if (!ok) {
+        fclose(d->file);
+        d->file = NULL;
+        return false;
+    }
+    use_info(d, &info);
+    d->file_start = raw != NULL ? 0 : (long) info.data_offset;
+    d->raw = malloc(DECODER_BLOCK_FRAMES * d->frame_size);
+    return d->raw != NULL;
+}
+
+// Leaves the decoding to the thread, which can take seconds for a long
+// compressed file; only a file that is not there fails here.
+static bool open_wave(Decoder *d, const char *path) {
+    if (!FileExists(path)) return false;
+    d->path = strdup(path);
+    if (d->path == NULL || sem_init(&d->loaded, 0, 0) != 0) return false;
+    d->deferred = true;
+    return true;
+}
+
+static bool open_stream(Decoder *d, const WavInfo *raw) {
+    if (raw == NULL) return false;
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    use_info(d, raw);
+    d->frame_count = DECODER_UNKNOWN_LENGTH;
+    d->stream = true;
+    d->fd = fileno(stdin);
+    d->raw = malloc(DECODER_BLOCK_FRAMES * d->frame_size);
+    return d->raw != NULL;
+}
+
+bool decoder_open(Decoder *d, const char *path, const WavInfo *raw, bool loop) {
+    memset(d, 0, sizeof(*d));
+    if (strcmp(path, "-") == 0) {
+        if (!open_stream(d, raw)) {
+            decoder_close(d);
+            return false;
+        }
+    } else {
+        if (open_mapped(d, path, raw)) {
+            d->loop = loop;
+            return true;
+        }
+        decoder_close(d);
+        if (!open_file(d, path, raw) && (raw != NULL || !open_wave(d, path))) {
+            decoder_close(d);
+            return false;
+        }
+        d->loop = loop;
+    }
+    // a deferred input's channels are known once loaded
+    if (!d->deferred) {
+        d->pool = malloc(sizeof(float) * DECODER_BLOCKS * DECODER_BLOCK_FRAMES * d->channels);
+        if (d->pool == NULL) {
+            decoder_close(d);
+            return false;
+        }
+    }
+    sem_init(&d->free, 0, DECODER_BLOCKS);
+    sem_init(&d->full, 0, 0);
+    if (pthread_create(&d->thread, NULL, produce, d) != 0) {
+        TraceLog(LOG_ERROR, "DECODE: Could not start the decoder thread");
+        sem_destroy(&d->free);
+        sem_destroy(&d->full);
+        decoder_close(d);
+        return false;
+    }
+    d->threaded = true;
+    return true;
+}
+
+bool decoder_wait_format(Decoder *d) {
+    if (d->deferred && !d->known) {
+        while (sem_wait(&d->loaded) != 0 && errno == EINTR) {}
+        d->known = true;
+    }
+    return d->sample_rate != 0;
+}
+
+static size_t read_mapped(Decoder *d, const float **samples, size_t max_frames) {
+    if (d->loop && d->position == d->frame_count) d->position = 0;
+    size_t n = d->frame_count - d->position;
+    if (n > max_frames) n = max_frames;
+    const unsigned char *src = d->data + d->position * d->frame_size;
+    if (d->format == PCM_F32 && (uintptr_t) src % sizeof(float) == 0) {
+        *samples = (const float *) src;
+    } else {
+        if (n > DECODER_BLOCK_FRAMES) n = DECODER_BLOCK_FRAMES;
+        pcm_to_float(src, d->format, d->scratch, n * d->channels);
+        *samples = d->scratch;
+    }
+    d->position += n;
+    d->ended = n == 0;
+    return n;
+}
+
+static size_t take(Decoder *d, const float **samples, size_t max_frames, bool block) {
+    if (d->ended) return 0;
+    if (d->map != NULL) return read_mapped(d, samples, max_frames);
+    size_t slot = d->tail % DECODER_BLOCKS;
+    // the caller is done with the previous pointer, a finished block goes back
+    if (d->holding && d->offset == d->frames[slot]) {
+        sem_post(&d->free);
+        d->holding = false;
+        slot = ++d->tail % DECODER_BLOCKS;
+    }
+    if (!d->holding) {
+        if (block) {
+            wait_for(&d->full, &d->consumer_wait);
+        } else if (sem_trywait(&d->full) != 0) {
+            return 0;
+        }
+        d->holding = true;
+        d->offset = 0;
+        if (d->frames[slot] == 0) {
+            d->ended = true;
+            return 0;
+        }
+        d->blocks++;
+    }
+
+    size_t n = d->frames[slot] - d->offset;
+    if (n > max_frames) n = max_frames;
+    *samples = d->pool + (slot * DECODER_BLOCK_FRAMES + d->offset) * d->channels;
+    d->offset += n;
+    return n;
+}
+
+size_t decoder_read(Decoder *d, const float **samples, size_t max_frames) {
+    return take(d, samples, max_frames, true);
+}
+
+size_t decoder_poll(Decoder *d, const float **samples, size_t max_frames) {
+    return take(d, samples, max_frames, false);
+}
+
+void decoder_close(Decoder *d) {
+    if (d->threaded) {
+        // wake the producer in case it waits for a block that never comes back
+        atomic_store(&d->stop, true);
+        sem_post(&d->free);
+        pthread_join(d->thread, NULL);
+        sem_destroy(&d->free);
+        sem_destroy(&d->full);
+        TraceLog(LOG_INFO, "DECODE: %zu blocks, decoder waited %.2fs for free blocks, analysis waited %.2fs for "
+                           "decoded ones", d->blocks, d->producer_wait, d->consumer_wait);
+    }
+    if (d->deferred) sem_destroy(&d->loaded);
+    close_mapped(d);
+    free(d->scratch);
+    if (d->file != NULL) fclose(d->file);
+    if (d->wave.data != NULL) UnloadWave(d->wave);
+    free(d->path);
+    free(d->raw);
+    free(d->pool);
+    memset(d, 0, sizeof(*d));
+}
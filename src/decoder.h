@@ -0,0 +1,103 @@
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <raylib.h>
+#include "wav.h"
+
+// Blocks in flight between the decoder and the analysis.
+#define DECODER_BLOCKS 8
+#define DECODER_BLOCK_FRAMES 8192
+// frame_count of a pipe
+#define DECODER_UNKNOWN_LENGTH SIZE_MAX
+
+// Sample source of the offline modes.
+//
+// WAV and raw PCM files are mapped and read in place: float samples go to
+// the analysis straight from the mapping, other formats are converted only
+// as far as the analysis asks for, and the kernel reads ahead.
+//
+// Everything else (and every file where there is no mmap) is decoded on a
+// thread into a ring of pooled sample blocks. The analysis takes the blocks
+// in order and hands each back once it has read past it, so decoding the
+// next blocks overlaps analysing this one. WAV is read from the file block
+// by block; other formats are decoded whole by raylib on the thread, which
+// then converts them block by block. The time either side spent waiting for
+// the other is logged on close, to size the ring. Standard input (path "-")
+// goes the same way, a block per read of whatever the pipe holds.
+typedef struct {
+    unsigned int sample_rate;
+    unsigned int channels;
+    size_t frame_count;
+
+    // mapped source
+    void *map;
+    size_t map_size;
+    const unsigned char *data;
+    size_t position;
+    float *scratch;
+
+    // start over at the end instead of ending
+    bool loop;
+
+    // decoded source, producer side
+    FILE *file;
+    long file_start;
+    // decoded by raylib on the thread, which posts loaded once the format
+    // is known or the file turned out not to decode
+    char *path;
+    bool deferred;
+    sem_t loaded;
+    Wave wave;
+    PcmFormat format;
+    size_t frame_size;
+    size_t produced;
+    unsigned char *raw;
+    // a pipe, read as it comes; carry bytes of a partial frame wait in raw
+    bool stream;
+    int fd;
+    size_t carry;
+
+    float *pool;
+    size_t frames[DECODER_BLOCKS]; // 0 marks the end of the input
+    sem_t free;
+    sem_t full;
+    pthread_t thread;
+    bool threaded;
+    _Atomic bool stop;
+
+    // consumer side; known once a deferred input's format has been waited for
+    bool known;
+    size_t tail;
+    size_t offset;
+    bool holding;
+    bool ended;
+    size_t blocks;
+
+    double producer_wait;
+    double consumer_wait;
+} Decoder;
+
+// raw describes a headerless PCM file (see pcm_parse), NULL for anything
+// else; it is required for standard input. A file opened to loop is read
+// from the start again, without decoding it again, where it would end; a
+// pipe ends anyway. Returns without decoding anything: the format fields
+// of a file raylib decodes are only valid once decoder_wait_format has
+// returned true.
+bool decoder_open(Decoder *d, const char *path, const WavInfo *raw, bool loop);
+// Waits until the format of the input is known, false if it does not decode.
+bool decoder_wait_format(Decoder *d);
+// Points samples at up to max_frames interleaved frames, valid until the
+// next call. Waits for the decoder if it is behind, returns 0 at the end.
+size_t decoder_read(Decoder *d, const float **samples, size_t max_frames);
+// decoder_read for pacing by a clock: returns 0 instead of waiting when
+// the decoder is behind, ended tells the two apart.
+size_t decoder_poll(Decoder *d, const float **samples, size_t max_frames);
+void decoder_close(Decoder *d);
+
+#endif // DECODER_H
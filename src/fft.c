@@ -0,0 +1,483 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <raylib.h>
+#include "fft.h"
+#ifdef HAVE_FFT_TABLES
+#include "fft_tables.h"
+#endif
+
+void fft(float in[], size_t stride, Float_Complex out[], size_t n) {
+    assert(n > 0 && (n & (n - 1)) == 0);
+
+    if (n == 1) {
+        out[0] = cfromreal(in[0]);
+        return;
+    }
+
+    fft(in, stride * 2, out, n / 2);
+    fft(in + stride, stride * 2, out + n / 2, n / 2);
+
+    for (size_t k = 0; k < n / 2; ++k) {
+        float t = (float) k / n;
+        Float_Complex v = mulcc(cexp(cfromimag(-2 * PI * t)), out[k + n / 2]);
+        Float_Complex e = out[k];
+        out[k] = addcc(e, v);
+        out[k + n / 2] = subcc(e, v);
+    }
+}
+
+// Quarter size of the first radix-4 stage; odd powers of two start with a
+// radix-2 stage.
+static size_t radix4_first(size_t n) {
+    size_t q = 1;
+    while (q * 4 <= n) q *= 4;
+    return q == n ? 1 : 2;
+}
+
+static Float_Complex root(size_t k, size_t n) {
+    // in double, so that the error of a twiddle does not grow with k
+    double angle = -2 * M_PI * k / n;
+    return CMPLXF((float) cos(angle), (float) sin(angle));
+}
+
+static bool power_of_two_init(FftPlan *plan) {
+    size_t n = plan->n;
+    if (n > UINT32_MAX) {
+        TraceLog(LOG_ERROR, "FFT: Size %zu is too large", n);
+        return false;
+    }
+#ifdef HAVE_FFT_TABLES
+    for (const FftTable *t = fft_tables; t->n != 0; ++t) {
+        if (t->n == n && t->kernel == plan->kernel) {
+            plan->twiddles = (const Float_Complex *) t->twiddles;
+            plan->twiddle_count = t->twiddle_count;
+            plan->reverse = t->reverse;
+            plan->baked = true;
+            return true;
+        }
+    }
+#endif
+    Float_Complex *twiddles = malloc(sizeof(Float_Complex) * n);
+    uint32_t *reverse = malloc(sizeof(uint32_t) * n);
+    plan->twiddles = twiddles;
+    plan->reverse = reverse;
+    if (twiddles == NULL || reverse == NULL) return false;
+
+    // every stage reads its twiddles in order from its own run of the table
+    Float_Complex *w = twiddles;
+    switch (plan->kernel) {
+    case FFT_RADIX2:
+        for (size_t half = 1; half < n; half *= 2) {
+            for (size_t k = 0; k < half; ++k) *w++ = root(k, 2 * half);
+        }
+        break;
+    case FFT_RADIX4:
+        for (size_t q = radix4_first(n); q < n; q *= 4) {
+            for (size_t k = 0; k < q; ++k) {
+                *w++ = root(2 * k, 4 * q);
+                *w++ = root(k, 4 * q);
+                *w++ = root(3 * k, 4 * q);
+            }
+        }
+        break;
+    case FFT_SPLIT_RADIX:
+        for (size_t m = 4; m <= n; m *= 2) {
+            for (size_t k = 0; k < m / 4; ++k) {
+                *w++ = root(k, m);
+                *w++ = root(3 * k, m);
+            }
+        }
+        break;
+    default:
+        break;
+    }
+
+    int bits = 0;
+    while (((size_t) 1 << bits) < n) bits++;
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t r = 0;
+        for (int b = 0; b < bits; ++b) r |= ((i >> b) & 1) << (bits - 1 - b);
+        reverse[i] = r;
+    }
+    plan->twiddle_count = w - twiddles;
+    return true;
+}
+
+// Splits n into radices, fours first; false if a prime factor is larger
+// than FFT_MAX_RADIX.
+static bool factor(FftPlan *plan) {
+    const unsigned int radices[] = { 4, 2, 3, 5, 7 };
+    size_t rest = plan->n;
+    plan->radix_count = 0;
+    for (size_t i = 0; i < sizeof(radices) / sizeof(radices[0]); ++i) {
+        while (rest % radices[i] == 0) {
+            plan->radices[plan->radix_count++] = radices[i];
+            rest /= radices[i];
+        }
+    }
+    return rest == 1;
+}
+
+static bool mixed_radix_init(FftPlan *plan) {
+    // level l combines radix p DFTs of size m into one of size p m, which
+    // takes (p - 1) m twiddles; that sums to less than 2n
+    size_t count = 2 * plan->n;
+    for (unsigned int p = 2; p <= FFT_MAX_RADIX; ++p) count += p;
+    Float_Complex *twiddles = malloc(sizeof(Float_Complex) * count);
+    plan->twiddles = twiddles;
+    if (twiddles == NULL) return false;
+
+    Float_Complex *w = twiddles;
+    size_t size = plan->n;
+    for (size_t l = 0; l < plan->radix_count; ++l) {
+        size_t p = plan->radices[l];
+        size_t m = size / p;
+        plan->level_twiddles[l] = w - twiddles;
+        for (size_t k = 0; k < m; ++k) {
+            for (size_t r = 1; r < p; ++r) *w++ = root(r * k, size);
+        }
+        size = m;
+    }
+    for (unsigned int p = 2; p <= FFT_MAX_RADIX; ++p) {
+        plan->roots[p] = w - twiddles;
+        for (size_t j = 0; j < p; ++j) *w++ = root(j, p);
+    }
+    plan->twiddle_count = w - twiddles;
+    return true;
+}
+
+static void complex_radix2(const FftPlan *plan, Float_Complex x[]);
+
+static bool bluestein_init(FftPlan *plan) {
+    size_t n = plan->n;
+    size_t m = 1;
+    while (m < 2 * n - 1) m *= 2;
+    // zeroed, fft_plan_free may get it before it is planned
+    plan->inner = calloc(1, sizeof(FftPlan));
+    plan->chirp = malloc(sizeof(Float_Complex) * n);
+    plan->filter = malloc(sizeof(Float_Complex) * m);
+    plan->work = malloc(sizeof(Float_Complex) * m);
+    if (plan->inner == NULL || plan->chirp == NULL || plan->filter == NULL || plan->work == NULL) return false;
+    if (!fft_plan_init(plan->inner, m, FFT_RADIX2)) {
+        free(plan->inner);
+        plan->inner = NULL;
+        return false;
+    }
+
+    // k^2 taken mod 2n keeps the angle small enough for double
+    for (size_t k = 0; k < n; ++k) {
+        double angle = -M_PI * (double) ((uint64_t) k * k % (2 * n)) / n;
+        plan->chirp[k] = CMPLXF((float) cos(angle), (float) sin(angle));
+    }
+    // the conjugate chirp at lags -(n - 1) to n - 1, wrapped around m; its
+    // transform carries the 1/m of the inverse transform
+    for (size_t j = 0; j < m; ++j) plan->filter[j] = 0.0f;
+    for (size_t j = 0; j < n; ++j) {
+        plan->filter[j] = conjf(plan->chirp[j]) / m;
+        if (j > 0) plan->filter[m - j] = conjf(plan->chirp[j]) / m;
+    }
+    complex_radix2(plan->inner, plan->filter);
+    return true;
+}
+
+bool fft_plan_init(FftPlan *plan, size_t n, FftKernel kernel) {
+    memset(plan, 0, sizeof(*plan));
+    plan->n = n;
+    if (n == 0) {
+        TraceLog(LOG_ERROR, "FFT: Size must not be 0");
+        return false;
+    }
+    bool ok;
+    if ((n & (n - 1)) == 0) {
+        plan->kernel = kernel == FFT_RADIX2 || kernel == FFT_SPLIT_RADIX ? kernel : FFT_RADIX4;
+        ok = power_of_two_init(plan);
+    } else if (factor(plan)) {
+        plan->kernel = FFT_MIXED_RADIX;
+        ok = mixed_radix_init(plan);
+    } else {
+        plan->kernel = FFT_BLUESTEIN;
+        ok = bluestein_init(plan);
+    }
+    if (!ok) {
+        TraceLog(LOG_ERROR, "FFT: Could not allocate a plan of size %zu", n);
+        fft_plan_free(plan);
+    }
+    return ok;
+}
+
+void fft_plan_free(FftPlan *plan) {
+    if (plan->inner != NULL) fft_plan_free(plan->inner);
+    free(plan->inner);
+    if (!plan->baked) {
+        free((void *) plan->twiddles);
+        free((void *) plan->reverse);
+    }
+    free(plan->chirp);
+    free(plan->filter);
+    free(plan->work);
+    plan->inner = NULL;
+    plan->twiddles = NULL;
+    plan->reverse = NULL;
+    plan->chirp = NULL;
+    plan->filter = NULL;
+    plan->work = NULL;
+}
+
+const float *fft_hann_window(size_t n, float fallback[]) {
+#ifdef HAVE_FFT_TABLES
+    for (const FftWindowTable *t = fft_window_tables; t->n != 0; ++t) {
+        if (t->n == n) return t->hann;
+    }
+#endif
+    for (size_t i = 0; i < n; ++i) {
+        fallback[i] = n > 1 ? (float) (0.5 - 0.5 * cos(2 * M_PI * i / (n - 1))) : 1.0f;
+    }
+    return fallback;
+}
+
+// Spelled out: the C operator goes through a NaN check and a libgcc call.
+static inline Float_Complex cmul(Float_Complex a, Float_Complex b) {
+    float ar = crealf(a), ai = cimagf(a), br = crealf(b), bi = cimagf(b);
+    return CMPLXF(ar * br - ai * bi, ar * bi + ai * br);
+}
+
+// -i z
+static inline Float_Complex rotate(Float_Complex z) {
+    return CMPLXF(cimagf(z), -crealf(z));
+}
+
+// Bit reversed input with the first radix-2 stage, whose twiddles are all 1.
+static void load_pairs(const FftPlan *plan, const float in[], size_t stride, Float_Complex out[]) {
+    const uint32_t *reverse = plan->reverse;
+    if (plan->n == 1) {
+        out[0] = cfromreal(in[0]);
+        return;
+    }
+    for (size_t i = 0; i < plan->n; i += 2) {
+        float a = in[reverse[i] * stride];
+        float b = in[reverse[i + 1] * stride];
+        out[i] = cfromreal(a + b);
+        out[i + 1] = cfromreal(a - b);
+    }
+}
+
+static void radix2(const FftPlan *plan, float in[], size_t stride, Float_Complex out[]) {
+    size_t n = plan->n;
+    load_pairs(plan, in, stride, out);
+    const Float_Complex *w = plan->twiddles + 1;
+    for (size_t half = 2; half < n; w += half, half *= 2) {
+        for (size_t start = 0; start < n; start += 2 * half) {
+            Float_Complex *a = out + start;
+            Float_Complex *b = a + half;
+            for (size_t k = 0; k < half; ++k) {
+                Float_Complex e = a[k];
+                Float_Complex v = cmul(w[k], b[k]);
+                a[k] = e + v;
+                b[k] = e - v;
+            }
+        }
+    }
+}
+
+// In bit reversed order the four quarters of a block of 4 q are the DFTs
+// of the samples 4m, 4m + 2, 4m + 1 and 4m + 3 of the block.
+static void radix4(const FftPlan *plan, float in[], size_t stride, Float_Complex out[]) {
+    size_t n = plan->n;
+    size_t q = radix4_first(n);
+    if (q == 2) {
+        load_pairs(plan, in, stride, out);
+    } else {
+        for (size_t i = 0; i < n; ++i) out[i] = cfromreal(in[plan->reverse[i] * stride]);
+    }
+    const Float_Complex *w = plan->twiddles;
+    for (; q < n; w += 3 * q, q *= 4) {
+        for (size_t start = 0; start < n; start += 4 * q) {
+            Float_Complex *x = out + start;
+            for (size_t k = 0; k < q; ++k) {
+                Float_Complex a = x[k];
+                Float_Complex b = cmul(w[3 * k], x[k + q]);
+                Float_Complex c = cmul(w[3 * k + 1], x[k + 2 * q]);
+                Float_Complex d = cmul(w[3 * k + 2], x[k + 3 * q]);
+                Float_Complex ab0 = a + b, ab1 = a - b;
+                Float_Complex cd0 = c + d, cd1 = rotate(c - d);
+                x[k] = ab0 + cd0;
+                x[k + q] = ab1 + cd1;
+                x[k + 2 * q] = ab0 - cd0;
+                x[k + 3 * q] = ab1 - cd1;
+            }
+        }
+    }
+}
+
+// DFT of size n of every stride-th value of in: the even samples as one of
+// size n/2, the samples 4m + 1 and 4m + 3 as two of size n/4.
+static void split_radix(const FftPlan *plan, const float in[], size_t stride, Float_Complex out[], size_t n) {
+    if (n == 1) {
+        out[0] = cfromreal(in[0]);
+        return;
+    }
+    if (n == 2) {
+        out[0] = cfromreal(in[0] + in[stride]);
+        out[1] = cfromreal(in[0] - in[stride]);
+        return;
+    }
+    if (n == 4) {
+        float x0 = in[0], x1 = in[stride], x2 = in[2 * stride], x3 = in[3 * stride];
+        out[0] = cfromreal(x0 + x1 + x2 + x3);
+        out[1] = CMPLXF(x0 - x2, x3 - x1);
+        out[2] = cfromreal(x0 - x1 + x2 - x3);
+        out[3] = CMPLXF(x0 - x2, x1 - x3);
+        return;
+    }
+    size_t q = n / 4;
+    split_radix(plan, in, stride * 2, out, n / 2);
+    split_radix(plan, in + stride, stride * 4, out + 2 * q, q);
+    split_radix(plan, in + 3 * stride, stride * 4, out + 3 * q, q);
+
+    // the twiddles of size n follow those of every smaller size
+    const Float_Complex *w = plan->twiddles + 2 * (q - 1);
+    for (size_t k = 0; k < q; ++k) {
+        Float_Complex z1 = cmul(w[2 * k], out[k + 2 * q]);
+        Float_Complex z3 = cmul(w[2 * k + 1], out[k + 3 * q]);
+        Float_Complex sum = z1 + z3;
+        Float_Complex diff = rotate(z1 - z3);
+        Float_Complex u0 = out[k];
+        Float_Complex u1 = out[k + q];
+        out[k] = u0 + sum;
+        out[k + 2 * q] = u0 - sum;
+        out[k + q] = u1 + diff;
+        out[k + 3 * q] = u1 - diff;
+    }
+}
+
+// DFT of size n of every stride-th value of in, from level on: p DFTs of
+// size n / p over the samples p j + r, combined by a radix p butterfly.
+static void mixed_radix(const FftPlan *plan, const float in[], size_t stride, Float_Complex out[], size_t n,
+                        size_t level) {
+    size_t p = plan->radices[level];
+    size_t m = n / p;
+    if (m == 1) {
+        for (size_t r = 0; r < p; ++r) out[r] = cfromreal(in[r * stride]);
+    } else {
+        for (size_t r = 0; r < p; ++r) mixed_radix(plan, in + r * stride, stride * p, out + r * m, m, level + 1);
+    }
+
+    const Float_Complex *w = plan->twiddles + plan->level_twiddles[level];
+    const Float_Complex *roots = plan->twiddles + plan->roots[p];
+    Float_Complex t[FFT_MAX_RADIX];
+    for (size_t k = 0; k < m; ++k, w += p - 1) {
+        t[0] = out[k];
+        for (size_t r = 1; r < p; ++r) t[r] = cmul(w[r - 1], out[r * m + k]);
+        switch (p) {
+        case 2:
+            out[k] = t[0] + t[1];
+            out[m + k] = t[0] - t[1];
+            break;
+        case 4: {
+            Float_Complex a0 = t[0] + t[2], a1 = t[0] - t[2];
+            Float_Complex b0 = t[1] + t[3], b1 = rotate(t[1] - t[3]);
+            out[k] = a0 + b0;
+            out[m + k] = a1 + b1;
+            out[2 * m + k] = a0 - b0;
+            out[3 * m + k] = a1 - b1;
+        } break;
+        case 3: {
+            const float s60 = 0.86602540378f;
+            Float_Complex sum = t[1] + t[2];
+            Float_Complex mid = t[0] - 0.5f * sum;
+            Float_Complex diff = s60 * rotate(t[1] - t[2]);
+            out[k] = t[0] + sum;
+            out[m + k] = mid + diff;
+            out[2 * m + k] = mid - diff;
+        } break;
+        case 5: {
+            const float c1 = 0.30901699437f, c2 = -0.80901699437f;
+            const float s1 = 0.95105651630f, s2 = 0.58778525229f;
+            Float_Complex s14 = t[1] + t[4], d14 = rotate(t[1] - t[4]);
+            Float_Complex s23 = t[2] + t[3], d23 = rotate(t[2] - t[3]);
+            Float_Complex a1 = t[0] + c1 * s14 + c2 * s23, b1 = s1 * d14 + s2 * d23;
+            Float_Complex a2 = t[0] + c2 * s14 + c1 * s23, b2 = s2 * d14 - s1 * d23;
+            out[k] = t[0] + s14 + s23;
+            out[m + k] = a1 + b1;
+            out[4 * m + k] = a1 - b1;
+            out[2 * m + k] = a2 + b2;
+            out[3 * m + k] = a2 - b2;
+        } break;
+        default:
+            for (size_t q = 0; q < p; ++q) {
+                Float_Complex sum = t[0];
+                size_t j = q;
+                for (size_t r = 1; r < p; ++r, j += q) {
+                    if (j >= p) j -= p;
+                    sum += cmul(roots[j], t[r]);
+                }
+                out[q * m + k] = sum;
+            }
+            break;
+        }
+    }
+}
+
+// In place radix-2 transform of complex x, for Bluestein's convolution.
+static void complex_radix2(const FftPlan *plan, Float_Complex x[]) {
+    size_t n = plan->n;
+    for (size_t i = 0; i < n; ++i) {
+        size_t j = plan->reverse[i];
+        if (i < j) {
+            Float_Complex t = x[i];
+            x[i] = x[j];
+            x[j] = t;
+        }
+    }
+    const Float_Complex *w = plan->twiddles;
+    for (size_t half = 1; half < n; w += half, half *= 2) {
+        for (size_t start = 0; start < n; start += 2 * half) {
+            Float_Complex *a = x + start;
+            Float_Complex *b = a + half;
+            for (size_t k = 0; k < half; ++k) {
+                Float_Complex e = a[k];
+                Float_Complex v = cmul(w[k], b[k]);
+                a[k] = e + v;
+                b[k] = e - v;
+            }
+        }
+    }
+}
+
+// X[k] = chirp[k] sum of x[j] chirp[j] conj(chirp[k - j]), the sum being a
+// circular convolution over inner->n; the inverse transform is the forward
+// one between two conjugations.
+static void bluestein(const FftPlan *plan, const float in[], size_t stride, Float_Complex out[]) {
+    size_t n = plan->n;
+    size_t m = plan->inner->n;
+    Float_Complex *x = plan->work;
+    for (size_t j = 0; j < n; ++j) x[j] = in[j * stride] * plan->chirp[j];
+    for (size_t j = n; j < m; ++j) x[j] = 0.0f;
+    complex_radix2(plan->inner, x);
+    for (size_t k = 0; k < m; ++k) x[k] = conjf(cmul(x[k], plan->filter[k]));
+    complex_radix2(plan->inner, x);
+    for (size_t k = 0; k < n; ++k) out[k] = cmul(plan->chirp[k], conjf(x[k]));
+}
+
+void fft_plan_execute(const FftPlan *plan, float in[], size_t stride, Float_Complex out[]) {
+    switch (plan->kernel) {
+    case FFT_RADIX2:
+        radix2(plan, in, stride, out);
+        break;
+    case FFT_RADIX4:
+        radix4(plan, in, stride, out);
+        break;
+    case FFT_SPLIT_RADIX:
+        split_radix(plan, in, stride, out, plan->n);
+        break;
+    case FFT_MIXED_RADIX:
+        mixed_radix(plan, in, stride, out, plan->n, 0);
+        break;
+    case FFT_BLUESTEIN:
+        bluestein(plan, in, stride, out);
+        break;
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <complex.h>
+
+#define Float_Complex float complex
+#define cfromreal(re) (re)
+#define cfromimag(im) ((im) * I)
+#define mulcc(a, b) ((a) * (b))
+#define addcc(a, b) ((a) + (b))
+#define subcc(a, b) ((a) - (b))
+
+// Radix-2 decimation in time over every stride-th value of in, n must be a
+// power of two; plans below take any n.
+void fft(float in[], size_t stride, Float_Complex out[], size_t n);
+
+// Any transform with fft()'s interface, for picking the engine at run time.
+typedef void Fft(float in[], size_t stride, Float_Complex out[], size_t n);
+
+// Largest prime a mixed radix plan splits by; sizes with larger prime
+// factors go through Bluestein.
+#define FFT_MAX_RADIX 7
+// Radices of a mixed radix size, enough for any size_t.
+#define FFT_MAX_FACTORS 64
+
+typedef enum {
+    // iterative, one butterfly of two points per step
+    FFT_RADIX2,
+    // two radix-2 stages fused into one pass over four points, three
+    // twiddle multiplications instead of four; one radix-2 stage first when
+    // log2 n is odd
+    FFT_RADIX4,
+    // recursive n/2 + n/4 + n/4 split, fewest multiplications of the three
+    FFT_SPLIT_RADIX,
+    // chosen by the plan for other sizes: recursive Cooley-Tukey over
+    // radices 4, 2, 3, 5 and 7
+    FFT_MIXED_RADIX,
+    // and for sizes with a larger prime factor: the DFT as a convolution
+    // with a chirp, done by a power of two plan of at least 2n - 1
+    FFT_BLUESTEIN,
+} FftKernel;
+
+// A transform of one size, with the twiddles and the bit reversal computed
+// up front so executing it only reads tables. Powers of two among the
+// sizes generated at build time take their tables from the binary instead.
+typedef struct FftPlan {
+    size_t n;
+    FftKernel kernel;
+    const Float_Complex *twiddles; // laid out in the order the kernel reads them
+    size_t twiddle_count;
+    const uint32_t *reverse;       // radix-2 and radix-4 read input reverse[i] into out[i]
+    // twiddles and reverse are tables built into the binary (fft_tables.h)
+    bool baked;
+
+    // mixed radix, outermost split first; the twiddles of every level are
+    // followed by the roots of unity of each radix
+    unsigned int radices[FFT_MAX_FACTORS];
+    size_t radix_count;
+    size_t level_twiddles[FFT_MAX_FACTORS];
+    size_t roots[FFT_MAX_RADIX + 1];
+
+    // Bluestein
+    struct FftPlan *inner;
+    Float_Complex *chirp;  // exp(-i pi k^2 / n) for k < n
+    Float_Complex *filter; // transform of the conjugate chirp, over inner->n
+    Float_Complex *work;   // inner->n, so executing is not reentrant
+} FftPlan;
+
+// kernel is used when n is a power of two, other sizes pick theirs.
+bool fft_plan_init(FftPlan *plan, size_t n, FftKernel kernel);
+// DFT of plan->n values, every stride-th of in; for powers of two the same
+// as fft().
+void fft_plan_execute(const FftPlan *plan, float in[], size_t stride, Float_Complex out[]);
+void fft_plan_free(FftPlan *plan);
+
+// Symmetric Hann window of n points, from the built in tables or else
+// computed into fallback, which holds n floats.
+const float *fft_hann_window(size_t n, float fallback[]);
+
+#endif // FFT_H
@@ -0,0 +1,102 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fft_backend.h"
+#include "fft_fixed.h"
+
+//
+// plans of fft.c
+//
+static void *plan_create(size_t n, FftKernel kernel) {
+    FftPlan *plan = malloc(sizeof(FftPlan));
+    if (plan == NULL) return NULL;
+    if (!fft_plan_init(plan, n, kernel)) {
+        free(plan);
+        return NULL;
+    }
+    return plan;
+}
+
+static void *radix2_create(size_t n) {
+    return plan_create(n, FFT_RADIX2);
+}
+
+static void *radix4_create(size_t n) {
+    return plan_create(n, FFT_RADIX4);
+}
+
+static void *split_create(size_t n) {
+    return plan_create(n, FFT_SPLIT_RADIX);
+}
+
+static void plan_execute(void *plan, float in[], size_t stride, Float_Complex out[]) {
+    fft_plan_execute(plan, in, stride, out);
+}
+
+static void plan_destroy(void *plan) {
+    fft_plan_free(plan);
+    free(plan);
+}
+
+const FftBackend fft_backend_radix2 = { "radix2", radix2_create, plan_execute, plan_destroy };
+const FftBackend fft_backend_radix4 = { "radix4", radix4_create, plan_execute, plan_destroy };
+const FftBackend fft_backend_split = { "split", split_create, plan_execute, plan_destroy };
+
+//
+// plain functions of a power of two size, with nothing to plan
+//
+typedef struct {
+    Fft *transform;
+    size_t n;
+} FunctionPlan;
+
+static void *function_create(Fft *transform, size_t n, size_t max_size) {
+    if (n == 0 || (n & (n - 1)) != 0 || n > max_size) return NULL;
+    FunctionPlan *plan = malloc(sizeof(FunctionPlan));
+    if (plan == NULL) return NULL;
+    plan->transform = transform;
+    plan->n = n;
+    return plan;
+}
+
+static void *recursive_create(size_t n) {
+    return function_create(fft, n, SIZE_MAX);
+}
+
+static void *fixed_create(size_t n) {
+    return function_create(fft_fixed, n, FFT_FIXED_MAX_SIZE);
+}
+
+static void function_execute(void *plan, float in[], size_t stride, Float_Complex out[]) {
+    FunctionPlan *p = plan;
+    p->transform(in, stride, out, p->n);
+}
+
+const FftBackend fft_backend_recursive = { "recursive", recursive_create, function_execute, free };
+const FftBackend fft_backend_fixed = { "fixed", fixed_create, function_execute, free };
+
+const FftBackend *const fft_backends[] = {
+    &fft_backend_recursive,
+    &fft_backend_radix2,
+    &fft_backend_radix4,
+    &fft_backend_split,
+    &fft_backend_fixed,
+#ifdef HAVE_FFTW
+    &fft_backend_fftw,
+#endif
+#ifdef HAVE_POCKETFFT
+    &fft_backend_pocketfft,
+#endif
+#ifdef HAVE_KISSFFT
+    &fft_backend_kissfft,
+#endif
+    NULL,
+};
+
+const FftBackend *fft_backend_find(const char *name) {
+    if (strcmp(name, "float") == 0) return &fft_backend_radix2;
+    for (size_t i = 0; fft_backends[i] != NULL; ++i) {
+        if (strcmp(fft_backends[i]->name, name) == 0) return fft_backends[i];
+    }
+    return NULL;
+}
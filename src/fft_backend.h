@@ -0,0 +1,42 @@
+#ifndef FFT_BACKEND_H
+#define FFT_BACKEND_H
+
+#include <stddef.h>
+#include "fft.h"
+
+// An FFT implementation behind one interface, so the in-tree kernels and
+// external libraries can be swapped and benchmarked against each other.
+// A plan transforms one size; all of them compute what fft() does, the
+// DFT of n reals taken every stride-th value of in, into n complex bins.
+typedef struct {
+    const char *name;
+    // NULL when the backend cannot transform n points or is out of memory
+    void *(*create)(size_t n);
+    void (*execute)(void *plan, float in[], size_t stride, Float_Complex out[]);
+    void (*destroy)(void *plan);
+} FftBackend;
+
+// In-tree: recursive (fft()), radix2, radix4, split and fixed.
+extern const FftBackend fft_backend_recursive;
+extern const FftBackend fft_backend_radix2;
+extern const FftBackend fft_backend_radix4;
+extern const FftBackend fft_backend_split;
+extern const FftBackend fft_backend_fixed;
+// External, each when configured with its library.
+#ifdef HAVE_FFTW
+extern const FftBackend fft_backend_fftw;
+#endif
+#ifdef HAVE_POCKETFFT
+extern const FftBackend fft_backend_pocketfft;
+#endif
+#ifdef HAVE_KISSFFT
+extern const FftBackend fft_backend_kissfft;
+#endif
+
+// Every backend built in, in-tree first, NULL terminated.
+extern const FftBackend *const fft_backends[];
+
+// By name; "float" is radix2, the default. NULL for an unknown name.
+const FftBackend *fft_backend_find(const char *name);
+
+#endif // FFT_BACKEND_H
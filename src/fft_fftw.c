@@ -0,0 +1,48 @@
+#include <limits.h>
+#include <stdlib.h>
+// after complex.h (through fft.h), so fftwf_complex is float complex
+#include "fft_backend.h"
+#include <fftw3.h>
+
+// FFTW's real to complex transform gives bins 0 to n/2, the rest mirror
+// them.
+typedef struct {
+    size_t n;
+    float *in;
+    fftwf_complex *out;
+    fftwf_plan plan;
+} FftwPlan;
+
+static void fftw_backend_destroy(void *plan) {
+    FftwPlan *p = plan;
+    if (p->plan != NULL) fftwf_destroy_plan(p->plan);
+    fftwf_free(p->in);
+    fftwf_free(p->out);
+    free(p);
+}
+
+static void *fftw_backend_create(size_t n) {
+    if (n == 0 || n > INT_MAX) return NULL;
+    FftwPlan *p = calloc(1, sizeof(FftwPlan));
+    if (p == NULL) return NULL;
+    p->n = n;
+    p->in = fftwf_alloc_real(n);
+    p->out = fftwf_alloc_complex(n / 2 + 1);
+    // measuring runs trial transforms on the buffers, before they hold anything
+    if (p->in != NULL && p->out != NULL) p->plan = fftwf_plan_dft_r2c_1d((int) n, p->in, p->out, FFTW_MEASURE);
+    if (p->plan == NULL) {
+        fftw_backend_destroy(p);
+        return NULL;
+    }
+    return p;
+}
+
+static void fftw_backend_execute(void *plan, float in[], size_t stride, Float_Complex out[]) {
+    FftwPlan *p = plan;
+    for (size_t i = 0; i < p->n; ++i) p->in[i] = in[i * stride];
+    fftwf_execute(p->plan);
+    for (size_t k = 0; k <= p->n / 2; ++k) out[k] = p->out[k];
+    for (size_t k = p->n / 2 + 1; k < p->n; ++k) out[k] = conjf(out[p->n - k]);
+}
+
+const FftBackend fft_backend_fftw = { "fftw", fftw_backend_create, fftw_backend_execute, fftw_backend_destroy };
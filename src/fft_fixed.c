@@ -0,0 +1,93 @@
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include "fft_fixed.h"
+
+static int16_t re[FFT_FIXED_MAX_SIZE];
+static int16_t im[FFT_FIXED_MAX_SIZE];
+static int16_t twiddle_re[FFT_FIXED_MAX_SIZE / 2];
+static int16_t twiddle_im[FFT_FIXED_MAX_SIZE / 2];
+static size_t twiddle_size = 0;
+
+static void make_twiddles(size_t n) {
+    if (twiddle_size == n) return;
+    for (size_t k = 0; k < n / 2; ++k) {
+        double angle = 2 * M_PI * k / n;
+        twiddle_re[k] = (int16_t) lrint(cos(angle) * 32767);
+        twiddle_im[k] = (int16_t) lrint(-sin(angle) * 32767);
+    }
+    twiddle_size = n;
+}
+
+static size_t reverse_bits(size_t i, int bits) {
+    size_t r = 0;
+    for (int b = 0; b < bits; ++b) {
+        r = (r << 1) | (i & 1);
+        i >>= 1;
+    }
+    return r;
+}
+
+static inline int32_t shift_round(int32_t x, int s) {
+    return s == 0 ? x : (x + (1 << (s - 1))) >> s;
+}
+
+static inline int32_t magnitude(int32_t x) {
+    return x < 0 ? -x : x;
+}
+
+void fft_fixed(float in[], size_t stride, Float_Complex out[], size_t n) {
+    assert(n > 0 && (n & (n - 1)) == 0 && n <= FFT_FIXED_MAX_SIZE);
+    make_twiddles(n);
+    int bits = 0;
+    while (((size_t) 1 << bits) < n) bits++;
+
+    // input exponent: the loudest sample just under 2^14
+    float loudest = 0.0f;
+    for (size_t i = 0; i < n; ++i) loudest = fmaxf(loudest, fabsf(in[i * stride]));
+    int exponent = 0;
+    if (loudest > 0.0f) frexpf(loudest, &exponent);
+    float scale = ldexpf(1.0f, 14 - exponent);
+    int32_t peak = 0;
+    for (size_t i = 0; i < n; ++i) {
+        size_t j = reverse_bits(i, bits);
+        re[j] = (int16_t) lrintf(in[i * stride] * scale);
+        im[j] = 0;
+        if (magnitude(re[j]) > peak) peak = magnitude(re[j]);
+    }
+
+    // a butterfly grows a value by up to 1 + sqrt(2), the shift keeps every
+    // output below 2^15 for inputs below 2^13, 2^14 and 2^15 respectively
+    int shifts = 0;
+    for (size_t half = 1; half < n; half *= 2) {
+        int s = peak < (1 << 13) ? 0 : peak < (1 << 14) ? 1 : 2;
+        shifts += s;
+        peak = 0;
+        size_t step = n / (2 * half);
+        for (size_t start = 0; start < n; start += 2 * half) {
+            for (size_t k = 0; k < half; ++k) {
+                int32_t wr = twiddle_re[k * step];
+                int32_t wi = twiddle_im[k * step];
+                size_t a = start + k;
+                size_t b = a + half;
+                int32_t tr = (wr * re[b] - wi * im[b] + (1 << 14)) >> 15;
+                int32_t ti = (wr * im[b] + wi * re[b] + (1 << 14)) >> 15;
+                int32_t ar = re[a];
+                int32_t ai = im[a];
+                int32_t r0 = shift_round(ar + tr, s);
+                int32_t i0 = shift_round(ai + ti, s);
+                int32_t r1 = shift_round(ar - tr, s);
+                int32_t i1 = shift_round(ai - ti, s);
+                re[a] = (int16_t) r0;
+                im[a] = (int16_t) i0;
+                re[b] = (int16_t) r1;
+                im[b] = (int16_t) i1;
+                int32_t m = magnitude(r0) | magnitude(i0) | magnitude(r1) | magnitude(i1);
+                if (m > peak) peak = m;
+            }
+        }
+    }
+
+    float unscale = ldexpf(1.0f, shifts - (14 - exponent));
+    for (size_t k = 0; k < n; ++k) out[k] = (re[k] * unscale) + (im[k] * unscale) * I;
+}
@@ -0,0 +1,48 @@
+#include <limits.h>
+#include <stdlib.h>
+#include "fft_backend.h"
+#include <kiss_fftr.h>
+
+// KissFFT's real transform takes even sizes and gives bins 0 to n/2, the
+// rest mirror them. Built for float samples, kiss_fft_scalar is float.
+typedef struct {
+    size_t n;
+    kiss_fftr_cfg cfg;
+    kiss_fft_scalar *in;
+    kiss_fft_cpx *out;
+} KissfftPlan;
+
+static void kissfft_backend_destroy(void *plan) {
+    KissfftPlan *p = plan;
+    kiss_fftr_free(p->cfg);
+    free(p->in);
+    free(p->out);
+    free(p);
+}
+
+static void *kissfft_backend_create(size_t n) {
+    if (n == 0 || n % 2 != 0 || n > INT_MAX) return NULL;
+    KissfftPlan *p = calloc(1, sizeof(KissfftPlan));
+    if (p == NULL) return NULL;
+    p->n = n;
+    p->cfg = kiss_fftr_alloc((int) n, 0, NULL, NULL);
+    p->in = malloc(sizeof(kiss_fft_scalar) * n);
+    p->out = malloc(sizeof(kiss_fft_cpx) * (n / 2 + 1));
+    if (p->cfg == NULL || p->in == NULL || p->out == NULL) {
+        kissfft_backend_destroy(p);
+        return NULL;
+    }
+    return p;
+}
+
+static void kissfft_backend_execute(void *plan, float in[], size_t stride, Float_Complex out[]) {
+    KissfftPlan *p = plan;
+    for (size_t i = 0; i < p->n; ++i) p->in[i] = in[i * stride];
+    kiss_fftr(p->cfg, p->in, p->out);
+    for (size_t k = 0; k <= p->n / 2; ++k) out[k] = CMPLXF(p->out[k].r, p->out[k].i);
+    for (size_t k = p->n / 2 + 1; k < p->n; ++k) out[k] = conjf(out[p->n - k]);
+}
+
+const FftBackend fft_backend_kissfft = {
+        "kissfft", kissfft_backend_create, kissfft_backend_execute, kissfft_backend_destroy
+};
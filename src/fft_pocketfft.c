@@ -0,0 +1,50 @@
+#include <stdlib.h>
+#include "fft_backend.h"
+#include "pocketfft.h"
+
+// The C pocketfft works in double, in place, and packs the result as r0,
+// r1, i1, r2, i2, ... up to bin n/2; the rest mirror it.
+typedef struct {
+    size_t n;
+    double *data;
+    rfft_plan plan;
+} PocketfftPlan;
+
+static void pocketfft_backend_destroy(void *plan) {
+    PocketfftPlan *p = plan;
+    if (p->plan != NULL) destroy_rfft_plan(p->plan);
+    free(p->data);
+    free(p);
+}
+
+static void *pocketfft_backend_create(size_t n) {
+    if (n == 0) return NULL;
+    PocketfftPlan *p = calloc(1, sizeof(PocketfftPlan));
+    if (p == NULL) return NULL;
+    p->n = n;
+    p->data = malloc(sizeof(double) * n);
+    if (p->data != NULL) p->plan = make_rfft_plan(n);
+    if (p->plan == NULL) {
+        pocketfft_backend_destroy(p);
+        return NULL;
+    }
+    return p;
+}
+
+static void pocketfft_backend_execute(void *plan, float in[], size_t stride, Float_Complex out[]) {
+    PocketfftPlan *p = plan;
+    size_t n = p->n;
+    for (size_t i = 0; i < n; ++i) p->data[i] = in[i * stride];
+    if (rfft_forward(p->plan, p->data, 1.0) != 0) {
+        for (size_t k = 0; k < n; ++k) out[k] = 0.0f;
+        return;
+    }
+    out[0] = (float) p->data[0];
+    for (size_t k = 1; 2 * k < n; ++k) out[k] = CMPLXF((float) p->data[2 * k - 1], (float) p->data[2 * k]);
+    if (n % 2 == 0) out[n / 2] = (float) p->data[n - 1];
+    for (size_t k = n / 2 + 1; k < n; ++k) out[k] = conjf(out[n - k]);
+}
+
+const FftBackend fft_backend_pocketfft = {
+        "pocketfft", pocketfft_backend_create, pocketfft_backend_execute, pocketfft_backend_destroy
+};
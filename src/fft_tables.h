@@ -0,0 +1,27 @@
+#ifndef FFT_TABLES_H
+#define FFT_TABLES_H
+
+#include "fft.h"
+
+// Plan tables and windows of the power of two sizes in
+// SPECTRALIZER_FFT_TABLE_SIZES, written at build time by tools/fft_tables.c
+// from the same code that computes them at run time. fft.c takes them when
+// built with HAVE_FFT_TABLES; other sizes are computed as before.
+typedef struct {
+    size_t n;
+    FftKernel kernel;
+    const float (*twiddles)[2]; // the layout of Float_Complex
+    size_t twiddle_count;
+    const uint32_t *reverse;
+} FftTable;
+
+typedef struct {
+    size_t n;
+    const float *hann;
+} FftWindowTable;
+
+// Both end with an entry of n = 0.
+extern const FftTable fft_tables[];
+extern const FftWindowTable fft_window_tables[];
+
+#endif // FFT_TABLES_H
@@ -0,0 +1,169 @@
+#include <string.h>
+#include <math.h>
+#include "loudness.h"
+
+#define LOUDNESS_MIN (-70.0f)
+
+static void biquad_set(Biquad *q, double b0, double b1, double b2, double a1, double a2) {
+    *q = (Biquad) {
+            .b0 = v4sf_splat(b0), .b1 = v4sf_splat(b1), .b2 = v4sf_splat(b2),
+            .a1 = v4sf_splat(a1), .a2 = v4sf_splat(a2),
+    };
+}
+
+// transposed direct form II, every lane is an independent channel
+static inline v4sf biquad(Biquad *q, v4sf x) {
+    v4sf y = q->b0 * x + q->z1;
+    q->z1 = q->b1 * x - q->a1 * y + q->z2;
+    q->z2 = q->b2 * x - q->a2 * y;
+    return y;
+}
+
+static float energy_to_lufs(double energy) {
+    return energy > 0 ? -0.691f + 10.0f * log10f(energy) : -INFINITY;
+}
+
+void loudness_init(LoudnessMeter *l, unsigned int sample_rate, unsigned int channels) {
+    memset(l, 0, sizeof(*l));
+    l->sample_rate = sample_rate;
+    l->channels = channels < LOUDNESS_MAX_CHANNELS ? channels : LOUDNESS_MAX_CHANNELS;
+    l->stride = channels;
+    l->block_size = sample_rate / 10;
+
+    // BS.1770 filters re-derived for the actual sample rate
+    double fs = sample_rate;
+    double f0 = 1681.974450955533;
+    double gain = 3.999843853973347;
+    double q = 0.7071752369554196;
+    double k = tan(M_PI * f0 / fs);
+    double vh = pow(10.0, gain / 20.0);
+    double vb = pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    biquad_set(&l->shelf,
+               (vh + vb * k / q + k * k) / a0,
+               2.0 * (k * k - vh) / a0,
+               (vh - vb * k / q + k * k) / a0,
+               2.0 * (k * k - 1.0) / a0,
+               (1.0 - k / q + k * k) / a0);
+
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = tan(M_PI * f0 / fs);
+    a0 = 1.0 + k / q + k * k;
+    biquad_set(&l->highpass, 1.0, -2.0, 1.0,
+               2.0 * (k * k - 1.0) / a0,
+               (1.0 - k / q + k * k) / a0);
+
+    // 48 tap Hann windowed sinc, split into 4 phases normalised to unity gain
+    const size_t phases = 4;
+    const size_t taps = phases * LOUDNESS_TRUE_PEAK_TAPS;
+    double sum[4] = { 0 };
+    double h[4 * LOUDNESS_TRUE_PEAK_TAPS];
+    for (size_t n = 0; n < taps; ++n) {
+        double x = (n - (taps - 1) / 2.0) / phases;
+        double w = 0.5 - 0.5 * cos(2 * M_PI * (n + 0.5) / taps);
+        h[n] = (x == 0 ? 1.0 : sin(M_PI * x) / (M_PI * x)) * w;
+        sum[n % phases] += h[n];
+    }
+    for (size_t k = 0; k < LOUDNESS_TRUE_PEAK_TAPS; ++k) {
+        for (size_t p = 0; p < phases; ++p) {
+            l->peak_taps[k][p] = h[k * phases + p] / sum[p];
+        }
+    }
+
+    l->momentary = -INFINITY;
+    l->short_term = -INFINITY;
+    l->integrated = -INFINITY;
+    l->true_peak = -INFINITY;
+}
+
+// Two pass gating over the histogram of momentary block loudness.
+static float integrate(const LoudnessMeter *l) {
+    double energy = 0;
+    size_t count = 0;
+    for (size_t i = 0; i < LOUDNESS_BINS; ++i) {
+        if (l->histogram[i] == 0) continue;
+        double lufs = LOUDNESS_MIN + (i + 0.5) * 0.1;
+        energy += l->histogram[i] * pow(10.0, (lufs + 0.691) / 10.0);
+        count += l->histogram[i];
+    }
+    if (count == 0) return -INFINITY;
+
+    float relative = energy_to_lufs(energy / count) - 10.0f;
+    size_t start = relative > LOUDNESS_MIN ? (size_t) ((relative - LOUDNESS_MIN) * 10.0f) : 0;
+    energy = 0;
+    count = 0;
+    for (size_t i = start; i < LOUDNESS_BINS; ++i) {
+        if (l->histogram[i] == 0) continue;
+        double lufs = LOUDNESS_MIN + (i + 0.5) * 0.1;
+        energy += l->histogram[i] * pow(10.0, (lufs + 0.691) / 10.0);
+        count += l->histogram[i];
+    }
+    return count ? energy_to_lufs(energy / count) : -INFINITY;
+}
+
+static void finish_block(LoudnessMeter *l) {
+    float energy = 0;
+    for (size_t c = 0; c < l->channels; ++c) energy += l->block_energy[c];
+    l->blocks[l->block_count % LOUDNESS_SHORT_TERM_BLOCKS] = energy / l->block_size;
+    l->block_count++;
+    l->block_energy = v4sf_splat(0);
+    l->block_fill = 0;
+
+    if (l->block_count >= LOUDNESS_MOMENTARY_BLOCKS) {
+        double sum = 0;
+        for (size_t i = 1; i <= LOUDNESS_MOMENTARY_BLOCKS; ++i) {
+            sum += l->blocks[(l->block_count - i) % LOUDNESS_SHORT_TERM_BLOCKS];
+        }
+        float momentary = energy_to_lufs(sum / LOUDNESS_MOMENTARY_BLOCKS);
+        atomic_store_explicit(&l->momentary, momentary, memory_order_relaxed);
+
+        // overlapping 400 ms gating blocks, 75% overlap
+        if (momentary >= LOUDNESS_MIN) {
+            size_t bin = (size_t) ((momentary - LOUDNESS_MIN) * 10.0f);
+            if (bin >= LOUDNESS_BINS) bin = LOUDNESS_BINS - 1;
+            l->histogram[bin]++;
+            atomic_store_explicit(&l->integrated, integrate(l), memory_order_relaxed);
+        }
+    }
+
+    if (l->block_count >= LOUDNESS_SHORT_TERM_BLOCKS) {
+        double sum = 0;
+        for (size_t i = 0; i < LOUDNESS_SHORT_TERM_BLOCKS; ++i) sum += l->blocks[i];
+        atomic_store_explicit(&l->short_term, energy_to_lufs(sum / LOUDNESS_SHORT_TERM_BLOCKS),
+                              memory_order_relaxed);
+    }
+
+    atomic_store_explicit(&l->true_peak, l->peak > 0 ? 20.0f * log10f(l->peak) : -INFINITY,
+                          memory_order_relaxed);
+}
+
+void loudness_process(LoudnessMeter *l, const float *frames, size_t count) {
+    size_t stride = l->stride;
+    for (size_t i = 0; i < count; ++i) {
+        const float *frame = frames + i * stride;
+        v4sf x = v4sf_splat(0);
+        for (size_t c = 0; c < l->channels; ++c) x[c] = frame[c];
+
+        v4sf y = biquad(&l->highpass, biquad(&l->shelf, x));
+        l->block_energy += y * y;
+
+        // history is stored twice so the taps never wrap
+        size_t pos = l->peak_pos;
+        for (size_t c = 0; c < l->channels; ++c) {
+            float *history = l->peak_history[c];
+            history[pos] = history[pos + LOUDNESS_TRUE_PEAK_TAPS] = frame[c];
+            v4sf acc = v4sf_splat(0);
+            for (size_t k = 0; k < LOUDNESS_TRUE_PEAK_TAPS; ++k) {
+                acc += l->peak_taps[k] * v4sf_splat(history[pos + LOUDNESS_TRUE_PEAK_TAPS - k]);
+            }
+            for (size_t p = 0; p < 4; ++p) {
+                float a = fabsf(acc[p]);
+                if (a > l->peak) l->peak = a;
+            }
+        }
+        l->peak_pos = (pos + 1) % LOUDNESS_TRUE_PEAK_TAPS;
+
+        if (++l->block_fill == l->block_size) finish_block(l);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef LOUDNESS_H
+#define LOUDNESS_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include "simd.h"
+
+// One SIMD lane per channel.
+#define LOUDNESS_MAX_CHANNELS 4
+// 400 ms momentary window and 3 s short-term window, in 100 ms blocks.
+#define LOUDNESS_MOMENTARY_BLOCKS 4
+#define LOUDNESS_SHORT_TERM_BLOCKS 30
+// Integrated gating histogram, 0.1 LU bins from -70 to +30 LUFS.
+#define LOUDNESS_BINS 1000
+#define LOUDNESS_TRUE_PEAK_TAPS 12
+
+typedef struct {
+    v4sf b0, b1, b2, a1, a2;
+    v4sf z1, z2;
+} Biquad;
+
+// EBU R128 / ITU-R BS.1770 meter. loudness_process() runs on the audio
+// thread, the readings are atomics so any other thread can poll them.
+typedef struct {
+    unsigned int sample_rate;
+    unsigned int channels;
+    unsigned int stride;
+
+    // K-weighting: high shelf then RLB high-pass
+    Biquad shelf;
+    Biquad highpass;
+
+    v4sf block_energy;
+    size_t block_size;
+    size_t block_fill;
+    float blocks[LOUDNESS_SHORT_TERM_BLOCKS];
+    size_t block_count;
+    unsigned int histogram[LOUDNESS_BINS];
+
+    // 4x oversampling for true peak, lane p holds polyphase branch p
+    v4sf peak_taps[LOUDNESS_TRUE_PEAK_TAPS];
+    float peak_history[LOUDNESS_MAX_CHANNELS][2 * LOUDNESS_TRUE_PEAK_TAPS];
+    size_t peak_pos;
+    float peak;
+
+    // readings, LUFS and dBTP; -INFINITY until there is enough signal
+    _Atomic float momentary;
+    _Atomic float short_term;
+    _Atomic float integrated;
+    _Atomic float true_peak;
+} LoudnessMeter;
+
+void loudness_init(LoudnessMeter *l, unsigned int sample_rate, unsigned int channels);
+// frames holds count interleaved frames of l->channels samples.
+void loudness_process(LoudnessMeter *l, const float *frames, size_t count);
+
+#endif // LOUDNESS_H
@@ -1,112 +1,328 @@
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include <raylib.h>
 #include <math.h>
-#include <complex.h>
+#include <time.h>
+#include <stdatomic.h>
 #include <rlgl.h>
 #include <raymath.h>
-
+#include "fft.h"
+#include "fft_backend.h"
+#include "record.h"
+#include "capture.h"
+#include "onset.h"
+#include "tempo.h"
+#include "loudness.h"
+#include "chroma.h"
+#include "pitch.h"
+#include "bench.h"
+#include "normalize.h"
+#include "simd.h"
+#include "shm_publish.h"
+#include "stream_server.h"
+#include "osc.h"
+#include "spectrogram.h"
+#include "cache.h"
+#include "decoder.h"
+#include "resample.h"
+
+// Analysis window in samples. Any length from PITCH_WINDOW up works, e.g.
+// 4410 for 100 ms at 44.1 kHz; powers of two are the fastest and the only
+// ones --fft fixed takes.
+#ifndef FFT_SIZE
 #define FFT_SIZE (1<<13)
+#endif
+// pitch detection reads its window from the ring
+static_assert(FFT_SIZE >= PITCH_WINDOW, "FFT_SIZE must hold PITCH_WINDOW samples");
+// The analysis runs on its own fixed clock, independent of the frame rate.
+#define ANALYSIS_RATE 120
+#define ANALYSIS_DT (1.0f / ANALYSIS_RATE)
+// Longest stall the analysis clock catches up on, in steps.
+#define ANALYSIS_MAX_STEPS 8
+// Peak caps stay put for PEAK_HOLD seconds, then fall with PEAK_GRAVITY.
+#define PEAK_HOLD 0.5f
+#define PEAK_GRAVITY 2.0f
 #define GLSL_VERSION 330
 
-#define Float_Complex float complex
-#define cfromreal(re) (re)
-#define cfromimag(im) ((im) * I)
-#define mulcc(a, b) ((a) * (b))
-#define addcc(a, b) ((a) + (b))
-#define subcc(a, b) ((a) - (b))
-
 // window related
 int window_width = 1600;
 int window_height = 800;
 char *window_title = "Audio Spectrum Visualizer in C";
 int target_fps = 144;
 
+// sample rate of the analysed signal
+unsigned int sample_rate = 44100;
+// inputs are resampled to this rate before the analysis, 0 keeps theirs
+unsigned int resample_rate = 44100;
+Resampler resampler;
+
+// offline rendering
+const char *input_path = "../audio/music.mp3";
+const char *render_path = NULL;
+const char *bench_suite = NULL;
+const char *shm_name = NULL;
+const char *stream_path = NULL;
+const char *osc_target = NULL;
+const char *spectrogram_path = NULL;
+const char *cache_dir = NULL;
+// headless PCM input, "FORMAT:RATE:CHANNELS"
+const char *pcm_spec = NULL;
+WavInfo pcm_info;
+// input of the window's analysis: raw PCM, or the played file decoded
+// alongside playback; samples owed to the analysis by the clock
+Decoder live_input;
+bool live_decoded = false;
+// its format, for a played file the music's, known before the decoder
+// thread has loaded it
+unsigned int live_rate = 0;
+unsigned int live_channels = 0;
+size_t live_length = 0;
+// a module, analysed from the stream processor instead
+bool live_module = false;
+double live_due = 0.0;
+// frames of live_input fed so far over every loop of the music and the
+// analysis steps run on them, the loops and the playback position last seen
+size_t live_fed = 0;
+size_t live_steps = 0;
+size_t live_loops = 0;
+double live_played = 0.0;
+uint64_t cache_budget = CACHE_DEFAULT_BUDGET;
+int render_fps = 60;
+
 // fft related
+const FftBackend *fft_backend = &fft_backend_radix2;
+void *spectrum_plan = NULL;
 Float_Complex out_raw[FFT_SIZE];
+// ring buffer, in_head is the index of the oldest sample
 float in_raw[FFT_SIZE];
+size_t in_head = 0;
 float in_win[FFT_SIZE];
+// Hann window, built in or computed into hann_fallback
+const float *hann_window = NULL;
+float hann_fallback[FFT_SIZE];
 float out_log[FFT_SIZE];
 float out_smooth[FFT_SIZE];
 float out_smear[FFT_SIZE];
-
-static void fft_push(float frame) {
-    memmove(in_raw, in_raw + 1, (FFT_SIZE - 1) * sizeof(in_raw[0]));
-    in_raw[FFT_SIZE - 1] = frame;
+float out_peak[FFT_SIZE];
+float peak_hold[FFT_SIZE];
+float peak_speed[FFT_SIZE];
+// first bin of every band, band i covers [band_edge[i], band_edge[i + 1])
+size_t band_edge[FFT_SIZE];
+// seconds of audio analysed so far
+double analysis_time = 0.0;
+uint64_t analysis_step = 0;
+// frame time not yet consumed by analysis steps, and the time of steps
+// skipped for want of new samples, of a module
+float analysis_lag = 0.0f;
+float analysis_idle = 0.0f;
+// frames the stream processor has fed a module's analysis
+_Atomic size_t module_frames = 0;
+size_t bands = 0;
+
+OnsetDetector onset;
+TempoTracker tempo;
+LoudnessMeter loudness;
+ChromaExtractor chroma;
+PitchTracker pitch;
+Normalizer normalizer;
+NormalizeStrategy normalize_strategy = NORMALIZE_PEAK;
+ShmPublisher publisher;
+StreamServer server;
+OscSender osc;
+OscFrame osc_frame;
+SpectrogramWriter spectrogram;
+SpectrumCache cache;
+// the cache entry being replayed on a hit, or written on a miss
+Spectrogram cached;
+SpectrogramWriter cache_writer;
+
+// Appends count samples taken every stride floats from frames.
+static void fft_push(const float *frames, size_t count, size_t stride) {
+    if (count > FFT_SIZE) {
+        frames += (count - FFT_SIZE) * stride;
+        count = FFT_SIZE;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        in_raw[in_head] = frames[i * stride];
+        in_head = (in_head + 1) % FFT_SIZE;
+    }
 }
 
-static void callback(void *bufferData, unsigned int frames) {
-    float (*fs)[2] = bufferData;
-    for (size_t i = 0; i < frames; ++i) {
-        fft_push(fs[i][0]);
+// Sets the resampler up for input_rate, returns the rate the analysis sees.
+static unsigned int ingest_init(unsigned int input_rate) {
+    unsigned int rate = resample_rate != 0 ? resample_rate : input_rate;
+    if (!resampler_init(&resampler, input_rate, rate)) {
+        TraceLog(LOG_WARNING, "RESAMPLE: Could not resample %u Hz, analysing as is", input_rate);
+        return input_rate;
     }
+    if (resampler_active(&resampler)) TraceLog(LOG_INFO, "RESAMPLE: %u Hz -> %u Hz", input_rate, rate);
+    return rate;
 }
 
-static void fft(float in[], size_t stride, Float_Complex out[], size_t n) {
-    assert(n > 0);
-
-    if (n == 1) {
-        out[0] = cfromreal(in[0]);
+// fft_push through the resampler.
+static void ingest(const float *frames, size_t count, size_t stride) {
+    if (!resampler_active(&resampler)) {
+        fft_push(frames, count, stride);
         return;
     }
-
-    fft(in, stride * 2, out, n / 2);
-    fft(in + stride, stride * 2, out + n / 2, n / 2);
-
-    for (size_t k = 0; k < n / 2; ++k) {
-        float t = (float) k / n;
-        Float_Complex v = mulcc(cexp(cfromimag(-2 * PI * t)), out[k + n / 2]);
-        Float_Complex e = out[k];
-        out[k] = addcc(e, v);
-        out[k + n / 2] = subcc(e, v);
+    while (count > 0) {
+        const float *out;
+        size_t produced;
+        size_t used = resampler_process(&resampler, frames, count, stride, &out, &produced);
+        fft_push(out, produced, 1);
+        frames += used * stride;
+        count -= used;
     }
 }
 
-static inline float amp(Float_Complex z) {
+// A module's stream, in the mixing format, float stereo.
+static void callback(void *bufferData, unsigned int frames) {
+    ingest(bufferData, frames, 2);
+    loudness_process(&loudness, bufferData, frames);
+    atomic_fetch_add(&module_frames, frames);
+}
+
+static inline float power(Float_Complex z) {
     float a = crealf(z);
     float b = cimagf(z);
-    return logf(a * a + b * b);
+    return a * a + b * b;
 }
 
-static size_t fft_analyze(float dt) {
+// Exact exponential approach of out_smooth towards out_log and of out_smear
+// towards out_smooth, stable for any dt. The peak caps ride on out_smooth:
+// pushed up by it, held, then falling faster and faster until they meet it.
+static void smooth_bands(size_t m, float dt) {
+    float smoothness = 8;
+    float smearness = 3;
+    v4sf ks = v4sf_splat(1.0f - expf(-smoothness * dt));
+    v4sf kr = v4sf_splat(1.0f - expf(-smearness * dt));
+    v4sf vdt = v4sf_splat(dt);
+    v4sf zero = v4sf_splat(0.0f);
+
+    // the arrays hold FFT_SIZE floats, rounding m up to whole vectors is safe
+    for (size_t i = 0; i < m; i += 4) {
+        v4sf target = v4sf_load(out_log + i);
+        v4sf smooth = v4sf_load(out_smooth + i);
+        v4sf smear = v4sf_load(out_smear + i);
+        smooth += (target - smooth) * ks;
+        smear += (smooth - smear) * kr;
+        v4sf_store(out_smooth + i, smooth);
+        v4sf_store(out_smear + i, smear);
+
+        v4sf peak = v4sf_load(out_peak + i);
+        v4sf hold = v4sf_max(v4sf_load(peak_hold + i) - vdt, zero);
+        v4sf speed = v4sf_load(peak_speed + i);
+        v4si rising = smooth >= peak;
+        v4si held = hold > zero;
+
+        v4sf fallen = v4sf_max(peak - speed * vdt, smooth);
+        peak = v4sf_select(rising, smooth, v4sf_select(held, peak, fallen));
+        speed = v4sf_select(rising | held, zero, speed + v4sf_splat(PEAK_GRAVITY) * vdt);
+        hold = v4sf_select(rising, v4sf_splat(PEAK_HOLD), hold);
+
+        v4sf_store(out_peak + i, peak);
+        v4sf_store(peak_hold + i, hold);
+        v4sf_store(peak_speed + i, speed);
+    }
+}
+
+// Computes this step's bands, chroma, pitch and onset flux from the ring.
+static size_t spectrum_analyze(float dt) {
     for (size_t i = 0; i < FFT_SIZE; ++i) {
-        float t = (float) i / (FFT_SIZE - 1);
-        float hann = 0.5 - 0.5 * cosf(2 * PI * t);
-        in_win[i] = in_raw[i] * hann;
+        in_win[i] = in_raw[(in_head + i) % FFT_SIZE] * hann_window[i];
     }
 
-    fft(in_win, 1, out_raw, FFT_SIZE);
+    fft_backend->execute(spectrum_plan, in_win, 1, out_raw);
 
     float step = 1.06f;
     float lowf = 1.0f;
     size_t m = 0;
-    float max_amp = 1.0f;
+    float max_amp = 0.0f;
 
+    chroma_begin(&chroma);
     for (float f = lowf; (size_t) f < FFT_SIZE / 2; f = ceilf(f * step)) {
         float f1 = ceilf(f * step);
         float a = 0.0f;
+        band_edge[m] = (size_t) f;
         for (size_t q = (size_t) f; q < FFT_SIZE / 2 && q < (size_t) f1; ++q) {
-            float b = amp(out_raw[q]);
+            float p = power(out_raw[q]);
+            chroma_accumulate(&chroma, q, p);
+            float b = logf(p);
             if (b > a) a = b;
         }
         if (max_amp < a) max_amp = a;
-        out_log[m++] = a;
+        out_log[m++] = normalize_apply(&normalizer, a);
     }
+    band_edge[m] = FFT_SIZE / 2;
+    normalize_update(&normalizer, max_amp, dt);
+    chroma_finish(&chroma);
+    pitch_update(&pitch, in_raw, FFT_SIZE, in_head, sample_rate);
+    onset_update(&onset, out_raw, FFT_SIZE / 2, band_edge, m, analysis_time);
+    return m;
+}
 
-    for (size_t i = 0; i < m; ++i) {
-        out_log[i] /= max_amp;
-    }
+// Stands in for spectrum_analyze on a cache hit with the frame cached for
+// the same time; replays loop with the music.
+static size_t cache_replay(void) {
+    double time = analysis_time;
+    double duration = spectrogram_frame(&cached, cached.count - 1)->time;
+    if (time > duration) time = fmod(time, duration);
+    const SpectrogramFrame *frame = spectrogram_frame(&cached, spectrogram_find(&cached, time));
+
+    size_t m = cached.header->bands;
+    memcpy(out_log, frame->levels, m * sizeof(float));
+    memcpy(chroma.chroma, frame->chroma, sizeof(chroma.chroma));
+    pitch.f0 = frame->f0;
+    pitch.confidence = frame->confidence;
+    onset_pick(&onset, frame->flux, frame->onset_band, analysis_time);
+    return m;
+}
 
-    for (size_t i = 0; i < m; ++i) {
-        float smoothness = 8;
-        out_smooth[i] += (out_log[i] - out_smooth[i]) * smoothness * dt;
-        float smearness = 3;
-        out_smear[i] += (out_smooth[i] - out_smear[i]) * smearness * dt;
+static size_t fft_analyze(float dt) {
+    analysis_time += dt;
+    size_t m = cached.map != NULL ? cache_replay() : spectrum_analyze(dt);
+    tempo_update(&tempo, onset.flux, analysis_time);
+
+    smooth_bands(m, dt);
+    shm_publish(&publisher, analysis_time, band_edge, out_smooth, m);
+    stream_server_publish(&server, analysis_step++, analysis_time, out_smooth, m);
+    if (osc_target != NULL) {
+        osc_frame.time = analysis_time;
+        osc_frame.bands = m < OSC_MAX_BANDS ? m : OSC_MAX_BANDS;
+        memcpy(osc_frame.levels, out_smooth, osc_frame.bands * sizeof(out_smooth[0]));
+        osc_frame.loudness[0] = loudness.momentary;
+        osc_frame.loudness[1] = loudness.short_term;
+        osc_frame.loudness[2] = loudness.integrated;
+        osc_frame.loudness[3] = loudness.true_peak;
+        osc_frame.bpm = tempo.bpm;
+        osc_frame.phase = tempo.phase;
+        osc_push(&osc, &osc_frame);
     }
 
     return m;
 }
 
+// Runs the analysis steps of a module covered by frame_time of wall clock.
+// The processor delivers in bursts; a step with no new samples since the
+// last would repeat its spectrum with zero flux, so it is folded into the
+// next one instead.
+static size_t analysis_advance(float frame_time) {
+    analysis_lag += frame_time;
+    if (analysis_lag > ANALYSIS_MAX_STEPS * ANALYSIS_DT) analysis_lag = ANALYSIS_MAX_STEPS * ANALYSIS_DT;
+    while (analysis_lag >= ANALYSIS_DT || bands == 0) {
+        analysis_lag -= ANALYSIS_DT;
+        analysis_idle += ANALYSIS_DT;
+        size_t frames = atomic_load(&module_frames);
+        if (frames == live_fed && bands != 0) continue;
+        live_fed = frames;
+        bands = fft_analyze(analysis_idle);
+        analysis_idle = 0.0f;
+    }
+    return bands;
+}
+
 Shader circle;
 int circle_radius_location;
 int circle_power_location;
@@ -114,6 +330,13 @@ int circle_power_location;
 Vector2 center = { };
 int radius = 0;
 int radius2 = 0;
+
+static void layout(int w, int h) {
+    center = (Vector2) { w / 2, h / 2};
+    radius2 = h - center.y;
+    radius = radius2 / 4;
+}
+
 static void fft_render(Rectangle boundary, size_t m) {
     // Width of a single bar
     float cell_width = boundary.width / m;
@@ -122,6 +345,9 @@ static void fft_render(Rectangle boundary, size_t m) {
     float saturation = 0.75f;
     float value = 1.0f;
 
+    // the inner ring breathes with the beat
+    float inner = radius * (1.0f + 0.1f * tempo_pulse(&tempo));
+
     //
     // Draw LINES
     //
@@ -133,8 +359,8 @@ static void fft_render(Rectangle boundary, size_t m) {
         // trigonometry
         float angle = (float) i * 2 * PI / m;
 
-        float start_x = center.x + radius * cos(angle);
-        float start_y = center.y + radius * sin(angle);
+        float start_x = center.x + inner * cos(angle);
+        float start_y = center.y + inner * sin(angle);
 
         float end_x = center.x + radius2 * cos(angle);
         float end_y = center.y + radius2 * sin(angle);
@@ -172,8 +398,8 @@ static void fft_render(Rectangle boundary, size_t m) {
         // trigonometry
         float angle = (float) i * 2 * PI / m;
 
-        float start_x = center.x + radius * cos(angle);
-        float start_y = center.y + radius * sin(angle);
+        float start_x = center.x + inner * cos(angle);
+        float start_y = center.y + inner * sin(angle);
 
         float end_x = center.x + radius2 * cos(angle);
         float end_y = center.y + radius2 * sin(angle);
@@ -192,6 +418,15 @@ static void fft_render(Rectangle boundary, size_t m) {
 
         // display shaders
         DrawTextureEx(texture, position, 0, 2 * radius, color);
+
+        // peak cap, same texture and shader so it stays in this batch
+        float p = out_peak[i];
+        float cap = cell_width * 0.75f + radius * 0.25f;
+        Vector2 cap_position = {
+                .x = Lerp(start_x, end_x, p) - cap,
+                .y = Lerp(start_y, end_y, p) - cap,
+        };
+        DrawTextureEx(texture, cap_position, 0, 2 * cap, ColorBrightness(color, 0.5f));
     }
     EndShaderMode();
 
@@ -210,8 +445,8 @@ static void fft_render(Rectangle boundary, size_t m) {
         // trigonometry
         float angle = (float) i * 2 * PI / m;
 
-        float start_x = center.x + radius * cos(angle);
-        float start_y = center.y + radius * sin(angle);
+        float start_x = center.x + inner * cos(angle);
+        float start_y = center.y + inner * sin(angle);
 
         float end_x = center.x + radius2 * cos(angle);
         float end_y = center.y + radius2 * sin(angle);
@@ -256,54 +491,507 @@ static void fft_render(Rectangle boundary, size_t m) {
     }
 
     EndShaderMode();
+
+    //
+    // Draw CHROMA wheel, C at the top
+    //
+    for (size_t i = 0; i < 12; ++i) {
+        float angle = (float) i * 2 * PI / 12 - PI / 2;
+        float t = chroma.chroma[i];
+        Vector2 position = {
+                center.x + inner * 0.8f * cosf(angle),
+                center.y + inner * 0.8f * sinf(angle),
+        };
+        Color color = ColorFromHSV(i * 30.0f, saturation, value);
+        DrawCircleV(position, 2 + 4 * t, Fade(color, 0.2f + 0.8f * t));
+    }
+}
+
+static void draw_frame(int w, int h, size_t m) {
+    const char *text = ">:)";
+    int font_size = 70;
+
+    ClearBackground(BLACK);
+    layout(w, h);
+
+    Rectangle preview_boundary = {
+            .x = 0,
+            .y = 0,
+            .width = w,
+            .height = h,
+    };
+
+    int mt = MeasureText(text, font_size);
+    DrawText(text, center.x - (mt / 2), center.y - (font_size / 2), font_size, RAYWHITE);
+
+    m -= 7;
+    fft_render(preview_boundary, m);
+}
+
+static void load_shaders(void) {
+    circle = LoadShader(0, TextFormat("../resources/shaders/glsl%d/circle.fs", GLSL_VERSION));
+    circle_radius_location = GetShaderLocation(circle, "radius");
+    circle_power_location = GetShaderLocation(circle, "power");
+}
+
+// Looks the input up in the cache once sample_rate is known. A hit replaces
+// the analysis with the cached frames; a miss is recorded into a new entry
+// when fill is set (the offline modes, which analyse on an exact clock).
+static void cache_begin(bool fill) {
+    if (cache_dir == NULL) return;
+    if (strcmp(input_path, "-") == 0) {
+        TraceLog(LOG_WARNING, "CACHE: Standard input is not cached");
+        cache_dir = NULL;
+        return;
+    }
+    const char *params = TextFormat("v%d fft=%d engine=%s window=hann rate=%d normalize=%d pcm=%s resample=%u",
+                                    SPECTROGRAM_VERSION, FFT_SIZE, fft_backend->name, ANALYSIS_RATE, (int) normalize_strategy,
+                                    pcm_spec != NULL ? pcm_spec : "-", resample_rate);
+    if (!cache_open(&cache, cache_dir, cache_budget, input_path, params)) {
+        cache_dir = NULL;
+        return;
+    }
+    if (cache_lookup(&cache, &cached, sample_rate, FFT_SIZE, ANALYSIS_RATE)) {
+        for (size_t i = 0; i <= cached.header->bands; ++i) band_edge[i] = cached.band_edge[i];
+        return;
+    }
+    if (fill && !spectrogram_writer_open(&cache_writer, cache.partial, sample_rate, FFT_SIZE, ANALYSIS_RATE)) {
+        TraceLog(LOG_WARNING, "CACHE: Could not create %s", cache.partial);
+    }
+}
+
+// complete tells whether the whole input went through the analysis.
+static void cache_end(bool complete) {
+    if (cache_dir == NULL) return;
+    if (cached.map != NULL) spectrogram_close(&cached);
+    if (cache_writer.file != NULL) {
+        if (spectrogram_writer_close(&cache_writer) && complete) {
+            cache_commit(&cache);
+        } else {
+            cache_discard(&cache);
+        }
+    }
+    cache_close(&cache);
+}
+
+// Input of the offline modes, decoded ahead on the decoder thread and fed
+// to the analysis on its own clock.
+typedef struct {
+    Decoder decoder;
+    size_t pushed;
+    size_t steps;
+    bool ended;
+} OfflineInput;
+
+static bool offline_open(OfflineInput *in) {
+    *in = (OfflineInput) { 0 };
+    if (!decoder_open(&in->decoder, input_path, pcm_spec != NULL ? &pcm_info : NULL, false)) return false;
+    if (!decoder_wait_format(&in->decoder)) {
+        decoder_close(&in->decoder);
+        return false;
+    }
+    sample_rate = ingest_init(in->decoder.sample_rate);
+    loudness_init(&loudness, in->decoder.sample_rate, in->decoder.channels);
+    chroma_init(&chroma, sample_rate, FFT_SIZE);
+
+    if (spectrogram_path != NULL
+        && !spectrogram_writer_open(&spectrogram, spectrogram_path, sample_rate, FFT_SIZE, ANALYSIS_RATE)) {
+        TraceLog(LOG_ERROR, "SPECTROGRAM: Could not create %s", spectrogram_path);
+        decoder_close(&in->decoder);
+        return false;
+    }
+    if (shm_name != NULL) shm_publish_open(&publisher, shm_name, sample_rate, FFT_SIZE);
+    if (stream_path != NULL) stream_server_start(&server, stream_path);
+    if (osc_target != NULL) osc_start(&osc, osc_target, &onset.queue);
+    cache_begin(true);
+    return true;
+}
+
+// Feeds the samples of the next analysis step and runs it.
+static size_t offline_step(OfflineInput *in) {
+    size_t end = (in->steps + 1) * in->decoder.sample_rate / ANALYSIS_RATE;
+    // a step can span decoder blocks
+    while (in->pushed < end && !in->ended) {
+        const float *samples;
+        size_t n = decoder_read(&in->decoder, &samples, end - in->pushed);
+        ingest(samples, n, in->decoder.channels);
+        loudness_process(&loudness, samples, n);
+        in->pushed += n;
+        in->ended = n == 0;
+    }
+    if (in->pushed >= in->decoder.frame_count) in->ended = true;
+    in->steps++;
+
+    size_t m = fft_analyze(ANALYSIS_DT);
+    if (spectrogram_path != NULL || cache_writer.file != NULL) {
+        SpectrogramFrame frame = {
+                .time = analysis_time,
+                .flux = onset.flux,
+                .onset_band = onset.band,
+                .f0 = pitch.f0,
+                .confidence = pitch.confidence,
+        };
+        memcpy(frame.chroma, chroma.chroma, sizeof(frame.chroma));
+        if (spectrogram_path != NULL) spectrogram_writer_write(&spectrogram, &frame, out_log, band_edge, m);
+        if (cache_writer.file != NULL) spectrogram_writer_write(&cache_writer, &frame, out_log, band_edge, m);
+    }
+    return m;
+}
+
+static bool offline_close(OfflineInput *in) {
+    cache_end(in->pushed == in->decoder.frame_count);
+    bool ok = true;
+    if (spectrogram_path != NULL && !spectrogram_writer_close(&spectrogram)) {
+        TraceLog(LOG_ERROR, "SPECTROGRAM: Failed to write %s", spectrogram_path);
+        ok = false;
+    }
+    if (osc_target != NULL) osc_stop(&osc);
+    stream_server_stop(&server);
+    shm_publish_close(&publisher);
+    decoder_close(&in->decoder);
+    resampler_free(&resampler);
+    pitch_free(&pitch);
+    return ok;
+}
+
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Analyses the whole input into spectrogram_path, no window, no audio device.
+static int analyze_offline(void) {
+    OfflineInput in;
+    if (!offline_open(&in)) return 1;
+
+    double start = now();
+    while (!in.ended) offline_step(&in);
+    double elapsed = now() - start;
+    TraceLog(LOG_INFO, "SPECTROGRAM: %zu frames in %.2fs (%.1fx realtime)", in.steps, elapsed,
+             (double) in.pushed / in.decoder.sample_rate / elapsed);
+
+    return offline_close(&in) ? 0 : 1;
+}
+
+// Renders the whole input file into render_path as fast as the GPU allows.
+// Every video frame advances the analysis by exactly sample_rate / fps
+// samples, so the output does not depend on how long a frame took to draw.
+static int render_offline(void) {
+    // nothing is presented, but GLFW still needs a (hidden) window for the
+    // context; on a headless box run under xvfb-run or a software GL stack
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(window_width, window_height, window_title);
+    SetTargetFPS(0);
+    load_shaders();
+
+    OfflineInput in;
+    if (!offline_open(&in)) {
+        CloseWindow();
+        return 1;
+    }
+
+    Recorder recorder;
+    if (!recorder_open(&recorder, render_path, window_width, window_height, render_fps)) {
+        offline_close(&in);
+        CloseWindow();
+        return 1;
+    }
+
+    RenderTexture2D target = LoadRenderTexture(window_width, window_height);
+    Capture capture;
+    if (!capture_init(&capture, &recorder, window_width, window_height)) {
+        UnloadRenderTexture(target);
+        recorder_close(&recorder);
+        offline_close(&in);
+        CloseWindow();
+        return 1;
+    }
+
+    size_t frames = SIZE_MAX;
+    if (in.decoder.frame_count != DECODER_UNKNOWN_LENGTH) {
+        frames = (in.decoder.frame_count * render_fps + in.decoder.sample_rate - 1) / in.decoder.sample_rate;
+    }
+    size_t m = 0;
+    double start = GetTime();
+    int status = 0;
+
+    for (size_t frame = 0; frame < frames; ++frame) {
+        // a pipe is done when it ends
+        if (frames == SIZE_MAX && in.ended) break;
+
+        // every analysis step ending by the end of this video frame
+        while ((in.steps + 1) * render_fps <= (frame + 1) * ANALYSIS_RATE || m == 0) {
+            m = offline_step(&in);
+        }
+
+        BeginTextureMode(target); {
+            draw_frame(window_width, window_height, m);
+        } EndTextureMode();
+
+        if (!capture_frame(&capture, target.id)) break;
+    }
+    if (!capture_close(&capture)) {
+        TraceLog(LOG_ERROR, "RECORD: Failed to write %s", render_path);
+        status = 1;
+    }
+
+    double elapsed = GetTime() - start;
+    TraceLog(LOG_INFO, "RECORD: %zu frames in %.2fs (%.1fx realtime)", recorder.frame, elapsed,
+             (double) recorder.frame / render_fps / elapsed);
+
+    if (!offline_close(&in)) status = 1;
+    recorder_close(&recorder);
+    UnloadRenderTexture(target);
+    UnloadShader(circle);
+    CloseWindow();
+    return status;
+}
+
+// Feeds the live_due frames owed to the analysis, never waiting for the
+// decoder, and runs a step wherever offline_step would, so the window sees
+// the steps the offline modes do. A played file's decoder loops with the
+// music.
+static void live_pump(void) {
+    for (size_t steps = 0; live_due >= 1.0 && steps < ANALYSIS_MAX_STEPS;) {
+        size_t end = (live_steps + 1) * live_rate / ANALYSIS_RATE;
+        size_t want = end - live_fed;
+        if (want > live_due) want = (size_t) live_due;
+
+        const float *samples;
+        size_t n = decoder_poll(&live_input, &samples, want);
+        if (n == 0) break;
+        ingest(samples, n, live_channels);
+        loudness_process(&loudness, samples, n);
+        live_due -= n;
+        live_fed += n;
+
+        if (live_fed == end) {
+            live_steps++;
+            steps++;
+            bands = fft_analyze(ANALYSIS_DT);
+        }
+    }
+}
+
+// Feeds raw PCM to the window's analysis at the rate it would play, never
+// waiting for it: a live source arrives at that rate anyway, a faster one
+// (a decoder writing into the pipe) is held back by the full block queue.
+static void raw_pump(float frame_time) {
+    live_due += frame_time * live_rate;
+    double most = (double) ANALYSIS_MAX_STEPS * live_rate / ANALYSIS_RATE;
+    if (live_due > most) live_due = most;
+    live_pump();
+}
+
+// Feeds the played file to the analysis up to the playback position.
+static void music_pump(Music music) {
+    double played = (double) GetMusicTimePlayed(music) * live_rate;
+    // the position wraps when the music loops
+    if (played + live_rate < live_played) live_loops++;
+    live_played = played;
+    live_due = (double) live_loops * live_length + played - live_fed;
+    live_pump();
+}
+
+static void usage(const char *program) {
+    fprintf(stderr,
+            "usage: %s [options] [input]\n"
+            "  --render PATH   render input to PATH (out.y4m or frames/%%05d.png) and exit\n"
+            "  --fps N         video frame rate for --render (default %d)\n"
+            "  --size WxH      window / video size (default %dx%d)\n"
+            "  --normalize S   band level reference: absolute, peak (default) or agc\n"
+            "  --shm NAME      publish the bands in POSIX shared memory NAME (e.g. %s)\n"
+            "  --stream PATH   serve band frames to subscribers on Unix socket PATH\n"
+            "  --osc HOST:PORT send bands, loudness, tempo and onsets as OSC over UDP\n"
+            "  --spectrogram PATH  write the analysis of input to PATH; without --render\n"
+            "                  only analyses, as fast as possible, and exits\n"
+            "  --pcm F:RATE:CH input is headerless PCM, F one of u8 s16 s24 s32 f32\n"
+            "                  (e.g. s16:48000:2); analysed, not played\n"
+            "  --stdin         read the input from standard input, as --pcm (default s16:44100:2)\n"
+            "  --resample HZ   analyse every input at HZ, 0 for the input's own rate (default %u)\n"
+            "  --fft BACKEND   spectrum FFT: float (default, radix2), radix4, split, fixed for\n"
+            "                  16 bit fixed point, or a library built in: fftw, pocketfft, kissfft\n"
+            "  --cache DIR     reuse the analysis of inputs seen before, kept in DIR\n"
+            "  --cache-size MB size budget of the --cache directory (default %d)\n"
+            "  --bench SUITE   run a benchmark (pitch, fixed, fft, kernels) and exit\n",
+            program, render_fps, window_width, window_height, SPECTRUM_SHM_DEFAULT_NAME, resample_rate,
+            (int) (CACHE_DEFAULT_BUDGET >> 20));
+}
+
+static bool parse_args(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (strcmp(arg, "--render") == 0 && has_value) {
+            render_path = argv[++i];
+        } else if (strcmp(arg, "--fps") == 0 && has_value) {
+            render_fps = atoi(argv[++i]);
+            if (render_fps <= 0) return false;
+        } else if (strcmp(arg, "--size") == 0 && has_value) {
+            if (sscanf(argv[++i], "%dx%d", &window_width, &window_height) != 2) return false;
+            if (window_width <= 0 || window_height <= 0) return false;
+        } else if (strcmp(arg, "--normalize") == 0 && has_value) {
+            if (!normalize_parse(argv[++i], &normalize_strategy)) return false;
+        } else if (strcmp(arg, "--shm") == 0 && has_value) {
+            shm_name = argv[++i];
+        } else if (strcmp(arg, "--stream") == 0 && has_value) {
+            stream_path = argv[++i];
+        } else if (strcmp(arg, "--osc") == 0 && has_value) {
+            osc_target = argv[++i];
+        } else if (strcmp(arg, "--spectrogram") == 0 && has_value) {
+            spectrogram_path = argv[++i];
+        } else if (strcmp(arg, "--pcm") == 0 && has_value) {
+            pcm_spec = argv[++i];
+            if (!pcm_parse(pcm_spec, &pcm_info)) return false;
+        } else if (strcmp(arg, "--resample") == 0 && has_value) {
+            int rate = atoi(argv[++i]);
+            if (rate < 0) return false;
+            resample_rate = rate;
+        } else if (strcmp(arg, "--fft") == 0 && has_value) {
+            fft_backend = fft_backend_find(argv[++i]);
+            if (fft_backend == NULL) return false;
+        } else if (strcmp(arg, "--stdin") == 0) {
+            input_path = "-";
+        } else if (strcmp(arg, "--cache") == 0 && has_value) {
+            cache_dir = argv[++i];
+        } else if (strcmp(arg, "--cache-size") == 0 && has_value) {
+            long long mb = atoll(argv[++i]);
+            if (mb <= 0) return false;
+            cache_budget = (uint64_t) mb << 20;
+        } else if (strcmp(arg, "--bench") == 0 && has_value) {
+            bench_suite = argv[++i];
+        } else if (arg[0] != '-' || strcmp(arg, "-") == 0) {
+            input_path = arg;
+        } else {
+            return false;
+        }
+    }
+    if (strcmp(input_path, "-") == 0 && pcm_spec == NULL) {
+        pcm_spec = "s16:44100:2";
+        pcm_parse(pcm_spec, &pcm_info);
+    }
+    return true;
 }
 
 int main(int argc, char **argv) {
+    if (!parse_args(argc, argv)) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (bench_suite != NULL) return bench_run(bench_suite);
+    spectrum_plan = fft_backend->create(FFT_SIZE);
+    if (spectrum_plan == NULL) {
+        TraceLog(LOG_ERROR, "FFT: The %s backend cannot transform %d points", fft_backend->name, FFT_SIZE);
+        return 1;
+    }
+    hann_window = fft_hann_window(FFT_SIZE, hann_fallback);
+    if (!pitch_init(&pitch)) {
+        fft_backend->destroy(spectrum_plan);
+        return 1;
+    }
+
+    normalize_init(&normalizer, normalize_strategy, FFT_SIZE);
+    onset_init(&onset);
+    tempo_init(&tempo);
+    if (render_path != NULL || spectrogram_path != NULL) {
+        int status = render_path != NULL ? render_offline() : analyze_offline();
+        fft_backend->destroy(spectrum_plan);
+        return status;
+    }
+
     SetConfigFlags(FLAG_WINDOW_RESIZABLE | FLAG_WINDOW_ALWAYS_RUN | FLAG_MSAA_4X_HINT);
     InitWindow(window_width, window_height, window_title);
     SetTargetFPS(target_fps);
 
-    InitAudioDevice();
-    Music music = LoadMusicStream("../audio/music.mp3");
-    AttachAudioStreamProcessor(music.stream, callback);
-    PlayMusicStream(music);
+    // raw PCM is only analysed, everything else is played
+    bool raw = pcm_spec != NULL;
+    Music music = { 0 };
+    if (raw) {
+        if (!decoder_open(&live_input, input_path, &pcm_info, false)) {
+            pitch_free(&pitch);
+            fft_backend->destroy(spectrum_plan);
+            CloseWindow();
+            return 1;
+        }
+        live_decoded = true;
+        live_rate = live_input.sample_rate;
+        live_channels = live_input.channels;
+        live_length = live_input.frame_count;
+        sample_rate = ingest_init(live_rate);
+        loudness_init(&loudness, live_rate, live_channels);
+    } else {
+        InitAudioDevice();
+        music = LoadMusicStream(input_path);
+        // processors see the stream in the mixing format, float stereo at
+        // the device's rate, which raylib does not tell; the analysis decodes
+        // the file again at its own rate, as offline. That happens on the
+        // decoder thread, so the format comes from the music. Modules are
+        // rendered at the device's rate, their stream's, and go through the
+        // processor.
+        if (!IsFileExtension(input_path, ".xm;.mod")) {
+            if (!decoder_open(&live_input, input_path, NULL, true)) {
+                CloseAudioDevice();
+                pitch_free(&pitch);
+                fft_backend->destroy(spectrum_plan);
+                CloseWindow();
+                return 1;
+            }
+            live_decoded = true;
+            live_rate = music.stream.sampleRate;
+            live_channels = music.stream.channels;
+            live_length = music.frameCount;
+            sample_rate = ingest_init(live_rate);
+            loudness_init(&loudness, live_rate, live_channels);
+        } else {
+            live_module = true;
+            sample_rate = ingest_init(music.stream.sampleRate);
+            loudness_init(&loudness, music.stream.sampleRate, 2);
+        }
+    }
+    chroma_init(&chroma, sample_rate, FFT_SIZE);
+    if (shm_name != NULL) shm_publish_open(&publisher, shm_name, sample_rate, FFT_SIZE);
+    if (stream_path != NULL) stream_server_start(&server, stream_path);
+    if (osc_target != NULL) osc_start(&osc, osc_target, &onset.queue);
+    cache_begin(false);
+    if (live_module) AttachAudioStreamProcessor(music.stream, callback);
+    if (!raw) PlayMusicStream(music);
 
-    circle = LoadShader(0, TextFormat("../resources/shaders/glsl%d/circle.fs", GLSL_VERSION));
-    circle_radius_location = GetShaderLocation(circle, "radius");
-    circle_power_location = GetShaderLocation(circle, "power");
+    load_shaders();
 
-    char *text = ">:)";
-    int font_size = 70;
-    int mt = MeasureText(text, font_size);
     while (!WindowShouldClose()) {
         BeginDrawing(); {
-            ClearBackground(BLACK);
-            int w = GetScreenWidth();
-            int h = GetScreenHeight();
-
-            center = (Vector2) { w / 2, h / 2};
-            radius2 = h - center.y;
-            radius = radius2 / 4;
-
-            UpdateMusicStream(music);
-            size_t m = fft_analyze(GetFrameTime());
-
-            Rectangle preview_boundary = {
-                    .x = 0,
-                    .y = 0,
-                    .width = w,
-                    .height = h,
-            };
-
-            DrawText(text, center.x - (mt / 2), center.y - (font_size / 2), font_size, RAYWHITE);
+            if (raw) {
+                raw_pump(GetFrameTime());
+            } else {
+                UpdateMusicStream(music);
+                if (live_decoded) music_pump(music);
+            }
+            size_t m = live_module ? analysis_advance(GetFrameTime()) : bands;
+
+            // nothing to draw before the first step
+            if (m > 0) {
+                draw_frame(GetScreenWidth(), GetScreenHeight(), m);
+            } else {
+                ClearBackground(BLACK);
+            }
             DrawFPS(10, 10);
-
-            m -= 7;
-            fft_render(preview_boundary, m);
+            DrawText(TextFormat("M %.1f  S %.1f  I %.1f LUFS  TP %.1f dBTP",
+                                loudness.momentary, loudness.short_term, loudness.integrated, loudness.true_peak),
+                     10, 35, 20, LIGHTGRAY);
+            DrawText(TextFormat("f0 %.1f Hz  %.0f%%", pitch.f0, pitch.confidence * 100), 10, 60, 20, LIGHTGRAY);
         } EndDrawing();
     }
 
-    CloseAudioDevice();
+    cache_end(false);
+    if (osc_target != NULL) osc_stop(&osc);
+    stream_server_stop(&server);
+    shm_publish_close(&publisher);
+    if (live_decoded) decoder_close(&live_input);
+    if (!raw) CloseAudioDevice();
+    resampler_free(&resampler);
+    pitch_free(&pitch);
+    fft_backend->destroy(spectrum_plan);
     CloseWindow();
     return 0;
 }
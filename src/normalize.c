@@ -0,0 +1,78 @@
+#include <string.h>
+#include <math.h>
+#include "normalize.h"
+
+// One dB expressed in natural-log power.
+#define LOG_POWER_PER_DB (0.1f * (float) M_LN10)
+// The reference never drops below this, the old per-frame floor.
+#define REFERENCE_FLOOR 1.0f
+
+void normalize_init(Normalizer *n, NormalizeStrategy strategy, size_t fft_size) {
+    memset(n, 0, sizeof(*n));
+    n->strategy = strategy;
+    // a full scale sine under a Hann window peaks at fft_size / 4
+    n->full_scale = 2.0f * logf(fft_size / 4.0f);
+    n->decay_db = 6.0f;
+    n->percentile = 0.95f;
+    n->reference = n->full_scale;
+    n->gain = 1.0f / n->reference;
+}
+
+bool normalize_parse(const char *name, NormalizeStrategy *strategy) {
+    if (strcmp(name, "absolute") == 0) *strategy = NORMALIZE_ABSOLUTE;
+    else if (strcmp(name, "peak") == 0) *strategy = NORMALIZE_PEAK;
+    else if (strcmp(name, "agc") == 0) *strategy = NORMALIZE_AGC;
+    else return false;
+    return true;
+}
+
+// k-th smallest of v, reorders v
+static float select_kth(float v[], size_t n, size_t k) {
+    size_t lo = 0;
+    size_t hi = n - 1;
+    while (lo < hi) {
+        float pivot = v[(lo + hi) / 2];
+        size_t i = lo;
+        size_t j = hi;
+        while (i <= j) {
+            while (v[i] < pivot) i++;
+            while (v[j] > pivot) j--;
+            if (i <= j) {
+                float t = v[i];
+                v[i] = v[j];
+                v[j] = t;
+                i++;
+                if (j == 0) break;
+                j--;
+            }
+        }
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else break;
+    }
+    return v[k];
+}
+
+void normalize_update(Normalizer *n, float frame_max, float dt) {
+    switch (n->strategy) {
+        case NORMALIZE_ABSOLUTE:
+            n->reference = n->full_scale;
+            break;
+        case NORMALIZE_PEAK:
+            n->reference -= n->decay_db * LOG_POWER_PER_DB * dt;
+            if (frame_max > n->reference) n->reference = frame_max;
+            break;
+        case NORMALIZE_AGC: {
+            n->history[n->frames % NORMALIZE_HISTORY] = frame_max;
+            size_t count = n->frames + 1 < NORMALIZE_HISTORY ? n->frames + 1 : NORMALIZE_HISTORY;
+            float scratch[NORMALIZE_HISTORY];
+            memcpy(scratch, n->history, count * sizeof(scratch[0]));
+            n->reference = select_kth(scratch, count, (size_t) (n->percentile * (count - 1)));
+            break;
+        }
+    }
+    n->frames++;
+
+    if (n->reference < REFERENCE_FLOOR) n->reference = REFERENCE_FLOOR;
+    n->gain = 1.0f / n->reference;
+}
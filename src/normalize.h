@@ -0,0 +1,47 @@
+#ifndef NORMALIZE_H
+#define NORMALIZE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Frames of band maxima the AGC takes its percentile over.
+#define NORMALIZE_HISTORY 256
+
+typedef enum {
+    // fixed full scale: a Hann windowed 0 dBFS sine maps to 1
+    NORMALIZE_ABSOLUTE,
+    // loudest band seen recently, decaying at decay_db per second
+    NORMALIZE_PEAK,
+    // percentile of the per-frame maxima over the last NORMALIZE_HISTORY frames
+    NORMALIZE_AGC,
+} NormalizeStrategy;
+
+// Band levels are natural-log powers. They are divided by a reference that
+// is known before the frame is banded, so the scaling happens inside the
+// banding loop and the frame's own maximum only feeds the next frame.
+typedef struct {
+    NormalizeStrategy strategy;
+    float full_scale;
+    float decay_db;
+    float percentile;
+
+    float reference;
+    float gain;
+
+    float history[NORMALIZE_HISTORY];
+    size_t frames;
+} Normalizer;
+
+void normalize_init(Normalizer *n, NormalizeStrategy strategy, size_t fft_size);
+// Maps "absolute", "peak" or "agc" to a strategy, returns false otherwise.
+bool normalize_parse(const char *name, NormalizeStrategy *strategy);
+
+static inline float normalize_apply(const Normalizer *n, float level) {
+    float v = level * n->gain;
+    return v < 0.0f ? 0.0f : v > 1.0f ? 1.0f : v;
+}
+
+// Feeds the loudest band level of the frame just banded.
+void normalize_update(Normalizer *n, float frame_max, float dt);
+
+#endif // NORMALIZE_H
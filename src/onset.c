@@ -0,0 +1,98 @@
+#include <string.h>
+#include <math.h>
+#include "onset.h"
+
+void onset_init(OnsetDetector *d) {
+    memset(d, 0, sizeof(*d));
+    d->threshold_scale = 1.5f;
+    d->threshold_bias = 0.01f;
+    d->min_interval = 0.05f;
+    d->last_onset = -INFINITY;
+}
+
+static void push(OnsetQueue *q, OnsetEvent event) {
+    size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    if (head - tail == ONSET_QUEUE) {
+        atomic_fetch_add_explicit(&q->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    q->events[head % ONSET_QUEUE] = event;
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+}
+
+bool onset_poll(OnsetQueue *q, OnsetEvent *event) {
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+    if (tail == head) return false;
+    *event = q->events[tail % ONSET_QUEUE];
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+static float median(const float values[], size_t n) {
+    float sorted[ONSET_HISTORY];
+    for (size_t i = 0; i < n; ++i) {
+        float v = values[i];
+        size_t j = i;
+        for (; j > 0 && sorted[j - 1] > v; --j) sorted[j] = sorted[j - 1];
+        sorted[j] = v;
+    }
+    return n % 2 ? sorted[n / 2] : 0.5f * (sorted[n / 2 - 1] + sorted[n / 2]);
+}
+
+void onset_update(OnsetDetector *d, const float complex spectrum[], size_t bins,
+                  const size_t band_edge[], size_t bands, double time) {
+    if (bins > ONSET_MAX_BINS) bins = ONSET_MAX_BINS;
+    if (bands > ONSET_MAX_BANDS) bands = ONSET_MAX_BANDS;
+
+    // half-wave rectified difference of log compressed magnitudes
+    float total = 0.0f;
+    float loudest = 0.0f;
+    unsigned int loudest_band = 0;
+    for (size_t b = 0; b < bands; ++b) {
+        float flux = 0.0f;
+        size_t end = band_edge[b + 1] < bins ? band_edge[b + 1] : bins;
+        for (size_t q = band_edge[b]; q < end; ++q) {
+            float re = crealf(spectrum[q]);
+            float im = cimagf(spectrum[q]);
+            float mag = log1pf(sqrtf(re * re + im * im));
+            float diff = mag - d->prev_mag[q];
+            d->prev_mag[q] = mag;
+            if (diff > 0) flux += diff;
+        }
+        d->band_flux[b] = flux;
+        total += flux;
+        if (flux > loudest) {
+            loudest = flux;
+            loudest_band = (unsigned int) b;
+        }
+    }
+    onset_pick(d, total / bins, loudest_band, time);
+}
+
+void onset_pick(OnsetDetector *d, float total, unsigned int loudest_band, double time) {
+    size_t n = d->frames < ONSET_HISTORY ? d->frames : ONSET_HISTORY;
+    d->threshold = median(d->history, n) * d->threshold_scale + d->threshold_bias;
+    d->history[d->frames % ONSET_HISTORY] = total;
+
+    // the previous frame is an onset if it is a local maximum over threshold
+    float peak = d->prev_flux[0];
+    if (d->frames >= 2 && peak > d->prev_flux[1] && peak >= total && peak > d->threshold
+        && d->prev_time - d->last_onset >= d->min_interval) {
+        push(&d->queue, (OnsetEvent) {
+                .time = d->prev_time,
+                .strength = peak - d->threshold,
+                .band = d->prev_band,
+        });
+        d->last_onset = d->prev_time;
+    }
+
+    d->prev_flux[1] = d->prev_flux[0];
+    d->prev_flux[0] = total;
+    d->prev_band = loudest_band;
+    d->prev_time = time;
+    d->flux = total;
+    d->band = loudest_band;
+    d->frames++;
+}
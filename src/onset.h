@@ -0,0 +1,67 @@
+#ifndef ONSET_H
+#define ONSET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <complex.h>
+
+// Analysis frames the adaptive threshold looks back over.
+#define ONSET_HISTORY 16
+// Must be a power of two.
+#define ONSET_QUEUE 256
+#define ONSET_MAX_BINS (1 << 16)
+#define ONSET_MAX_BANDS 1024
+
+typedef struct {
+    double time;      // analysis clock, seconds
+    float strength;   // flux above the threshold
+    unsigned int band;// band that contributed most flux
+} OnsetEvent;
+
+// Single producer (the analysis) / single consumer queue, the producer never
+// blocks and drops events when the consumer falls behind.
+typedef struct {
+    OnsetEvent events[ONSET_QUEUE];
+    _Atomic size_t head;
+    _Atomic size_t tail;
+    _Atomic size_t dropped;
+} OnsetQueue;
+
+typedef struct {
+    // tuning
+    float threshold_scale; // times the median of recent flux
+    float threshold_bias;  // added to the scaled median
+    float min_interval;    // seconds between onsets
+
+    // latest frame, exposed to the renderer
+    float band_flux[ONSET_MAX_BANDS];
+    float flux;
+    unsigned int band;     // band that contributed most flux
+    float threshold;
+
+    // state
+    float prev_mag[ONSET_MAX_BINS];
+    float history[ONSET_HISTORY];
+    size_t frames;
+    float prev_flux[2];
+    unsigned int prev_band;
+    double prev_time;
+    double last_onset;
+
+    OnsetQueue queue;
+} OnsetDetector;
+
+void onset_init(OnsetDetector *d);
+// Feeds one analysis frame: bins spectrum values, grouped into the bands
+// [band_edge[i], band_edge[i + 1]). Onsets are picked one frame late, once
+// the flux has been seen to fall again.
+void onset_update(OnsetDetector *d, const float complex spectrum[], size_t bins,
+                  const size_t band_edge[], size_t bands, double time);
+// The peak picking half of onset_update, for a flux computed elsewhere
+// (a replayed analysis).
+void onset_pick(OnsetDetector *d, float flux, unsigned int band, double time);
+// Consumer side, returns false when the queue is empty.
+bool onset_poll(OnsetQueue *q, OnsetEvent *event);
+
+#endif // ONSET_H
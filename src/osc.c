@@ -0,0 +1,238 @@
+#include <string.h>
+#include <stdio.h>
+#include <raylib.h>
+#include "osc.h"
+
+// Onsets folded into one bundle at most, the rest wait for the next one.
+#define OSC_MAX_ONSETS 32
+
+typedef struct {
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+    bool overflow;
+} OscWriter;
+
+static void put(OscWriter *w, const void *bytes, size_t n) {
+    if (w->size + n > w->capacity) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->data + w->size, bytes, n);
+    w->size += n;
+}
+
+// OSC is big-endian throughout
+static void put_u32(OscWriter *w, uint32_t v) {
+    unsigned char b[4] = { v >> 24, v >> 16, v >> 8, v };
+    put(w, b, 4);
+}
+
+static void put_u64(OscWriter *w, uint64_t v) {
+    put_u32(w, (uint32_t) (v >> 32));
+    put_u32(w, (uint32_t) v);
+}
+
+static void put_f32(OscWriter *w, float f) {
+    uint32_t v;
+    memcpy(&v, &f, 4);
+    put_u32(w, v);
+}
+
+static void put_f64(OscWriter *w, double d) {
+    uint64_t v;
+    memcpy(&v, &d, 8);
+    put_u64(w, v);
+}
+
+// NUL terminated and padded to a multiple of four bytes
+static void put_string(OscWriter *w, const char *s) {
+    size_t n = strlen(s);
+    static const unsigned char zeros[4] = { 0 };
+    put(w, s, n);
+    put(w, zeros, 4 - n % 4);
+}
+
+// Starts a bundle element, returns where its size field goes.
+static size_t begin_message(OscWriter *w, const char *address, const char *tags) {
+    size_t start = w->size;
+    put_u32(w, 0);
+    put_string(w, address);
+    put_string(w, tags);
+    return start;
+}
+
+static void end_message(OscWriter *w, size_t start) {
+    if (w->overflow) return;
+    uint32_t n = (uint32_t) (w->size - start - 4);
+    unsigned char b[4] = { n >> 24, n >> 16, n >> 8, n };
+    memcpy(w->data + start, b, 4);
+}
+
+size_t osc_encode(unsigned char *out, size_t capacity, const OscFrame *frame,
+                  const OnsetEvent onsets[], size_t onset_count) {
+    OscWriter w = { .data = out, .capacity = capacity };
+    put_string(&w, "#bundle");
+    put_u64(&w, 1); // "immediately"
+
+    size_t bands = frame->bands < OSC_MAX_BANDS ? frame->bands : OSC_MAX_BANDS;
+    size_t start = w.size;
+    put_u32(&w, 0);
+    put_string(&w, "/spectralizer/bands");
+    // type tags: ',' then one 'f' per band, NUL, padding
+    size_t tags = bands + 1;
+    for (size_t i = 0; i < tags + 4 - tags % 4; ++i) {
+        unsigned char c = i == 0 ? ',' : i < tags ? 'f' : 0;
+        put(&w, &c, 1);
+    }
+    for (size_t i = 0; i < bands; ++i) put_f32(&w, frame->levels[i]);
+    end_message(&w, start);
+
+    start = begin_message(&w, "/spectralizer/loudness", ",ffff");
+    for (size_t i = 0; i < 4; ++i) put_f32(&w, frame->loudness[i]);
+    end_message(&w, start);
+
+    start = begin_message(&w, "/spectralizer/tempo", ",ff");
+    put_f32(&w, frame->bpm);
+    put_f32(&w, frame->phase);
+    end_message(&w, start);
+
+    for (size_t i = 0; i < onset_count; ++i) {
+        start = begin_message(&w, "/spectralizer/onset", ",dfi");
+        put_f64(&w, onsets[i].time);
+        put_f32(&w, onsets[i].strength);
+        put_u32(&w, onsets[i].band);
+        end_message(&w, start);
+    }
+
+    return w.overflow ? 0 : w.size;
+}
+
+#ifndef _WIN32
+
+#include <netdb.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+static void *sender(void *arg) {
+    OscSender *o = arg;
+    OnsetEvent onsets[OSC_MAX_ONSETS];
+
+    while (atomic_load_explicit(&o->running, memory_order_relaxed)) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += 100 * 1000 * 1000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+        if (sem_timedwait(&o->ready, &deadline) != 0) continue;
+
+        size_t tail = atomic_load_explicit(&o->tail, memory_order_relaxed);
+        size_t head = atomic_load_explicit(&o->head, memory_order_acquire);
+        for (; tail != head; ++tail) {
+            size_t count = 0;
+            while (o->onsets != NULL && count < OSC_MAX_ONSETS && onset_poll(o->onsets, &onsets[count])) count++;
+
+            size_t size = osc_encode(o->packet, sizeof(o->packet), &o->frames[tail % OSC_FRAMES], onsets, count);
+            if (size > 0 && send(o->fd, o->packet, size, 0) == (ssize_t) size) o->sent++;
+        }
+        atomic_store_explicit(&o->tail, tail, memory_order_release);
+    }
+    return NULL;
+}
+
+bool osc_start(OscSender *o, const char *target, OnsetQueue *onsets) {
+    memset(o, 0, sizeof(*o));
+    o->fd = -1;
+    o->onsets = onsets;
+
+    char host[256] = "127.0.0.1";
+    const char *port = target;
+    const char *colon = strrchr(target, ':');
+    if (colon != NULL) {
+        snprintf(host, sizeof(host), "%.*s", (int) (colon - target), target);
+        port = colon + 1;
+    }
+
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_DGRAM };
+    struct addrinfo *addr = NULL;
+    if (getaddrinfo(host, port, &hints, &addr) != 0) {
+        TraceLog(LOG_ERROR, "OSC: Could not resolve %s", target);
+        return false;
+    }
+    o->fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+    bool ok = o->fd >= 0 && connect(o->fd, addr->ai_addr, addr->ai_addrlen) == 0;
+    freeaddrinfo(addr);
+    if (!ok) {
+        TraceLog(LOG_ERROR, "OSC: Could not open a UDP socket to %s", target);
+        if (o->fd >= 0) close(o->fd);
+        o->fd = -1;
+        return false;
+    }
+
+    sem_init(&o->ready, 0, 0);
+    atomic_store(&o->running, true);
+    if (pthread_create(&o->thread, NULL, sender, o) != 0) {
+        TraceLog(LOG_ERROR, "OSC: Could not start the sender thread");
+        atomic_store(&o->running, false);
+        sem_destroy(&o->ready);
+        close(o->fd);
+        o->fd = -1;
+        return false;
+    }
+    TraceLog(LOG_INFO, "OSC: Sending to %s:%s", host, port);
+    return true;
+}
+
+void osc_push(OscSender *o, const OscFrame *frame) {
+    if (!atomic_load_explicit(&o->running, memory_order_relaxed)) return;
+
+    size_t head = atomic_load_explicit(&o->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&o->tail, memory_order_acquire);
+    if (head - tail == OSC_FRAMES) {
+        atomic_fetch_add_explicit(&o->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    OscFrame *slot = &o->frames[head % OSC_FRAMES];
+    size_t bands = frame->bands < OSC_MAX_BANDS ? frame->bands : OSC_MAX_BANDS;
+    // only the used part of the band array
+    memcpy(slot, frame, offsetof(OscFrame, levels) + bands * sizeof(frame->levels[0]));
+    memcpy(slot->loudness, frame->loudness, sizeof(OscFrame) - offsetof(OscFrame, loudness));
+    slot->bands = bands;
+    atomic_store_explicit(&o->head, head + 1, memory_order_release);
+    sem_post(&o->ready);
+}
+
+void osc_stop(OscSender *o) {
+    if (atomic_exchange(&o->running, false)) {
+        pthread_join(o->thread, NULL);
+        sem_destroy(&o->ready);
+        TraceLog(LOG_INFO, "OSC: %llu bundles sent, %llu frames dropped",
+                 (unsigned long long) o->sent, (unsigned long long) o->dropped);
+    }
+    if (o->fd >= 0) close(o->fd);
+    o->fd = -1;
+}
+
+#else
+
+bool osc_start(OscSender *o, const char *target, OnsetQueue *onsets) {
+    (void) target;
+    memset(o, 0, sizeof(*o));
+    o->onsets = onsets;
+    TraceLog(LOG_WARNING, "OSC: UDP output is only implemented for POSIX sockets");
+    return false;
+}
+
+void osc_push(OscSender *o, const OscFrame *frame) {
+    (void) o;
+    (void) frame;
+}
+
+void osc_stop(OscSender *o) {
+    (void) o;
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef OSC_H
+#define OSC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include "onset.h"
+
+#define OSC_MAX_BANDS 1024
+// Analysis frames waiting for the sender thread, power of two.
+#define OSC_FRAMES 4
+// Largest bundle: every band as a float plus loudness, tempo and onsets.
+#define OSC_PACKET (8 * OSC_MAX_BANDS + 4096)
+
+// Everything one bundle reports about an analysis frame.
+typedef struct {
+    double time;
+    size_t bands;
+    float levels[OSC_MAX_BANDS];
+    float loudness[4]; // momentary, short-term, integrated LUFS, true peak dBTP
+    float bpm;
+    float phase;
+} OscFrame;
+
+// Sends one OSC bundle per analysis frame over UDP:
+//   /spectralizer/bands    ,f...  out_smooth
+//   /spectralizer/loudness ,ffff  momentary short-term integrated true-peak
+//   /spectralizer/tempo    ,ff    bpm beat-phase
+//   /spectralizer/onset    ,dfi   time strength band, one per onset
+// Encoding and sending happen on a dedicated thread, which is also the
+// consumer of the onset queue.
+typedef struct {
+    int fd;
+    OnsetQueue *onsets;
+    pthread_t thread;
+    sem_t ready;
+    _Atomic bool running;
+
+    OscFrame frames[OSC_FRAMES];
+    _Atomic size_t head;
+    _Atomic size_t tail;
+    _Atomic uint64_t dropped;
+
+    unsigned char packet[OSC_PACKET];
+    uint64_t sent;
+} OscSender;
+
+// target is "host:port", port alone means localhost. onsets may be NULL.
+bool osc_start(OscSender *o, const char *target, OnsetQueue *onsets);
+// Copies the frame for the sender thread, never blocks.
+void osc_push(OscSender *o, const OscFrame *frame);
+// Only after osc_start: a zero initialised sender's fd is 0.
+void osc_stop(OscSender *o);
+
+// Encodes a bundle of frame plus the given onsets into out, returns its size
+// or 0 if it does not fit.
+size_t osc_encode(unsigned char *out, size_t capacity, const OscFrame *frame,
+                  const OnsetEvent onsets[], size_t onset_count);
+
+#endif // OSC_H
@@ -0,0 +1,103 @@
+#include <string.h>
+#include <math.h>
+#include "pitch.h"
+
+#define PITCH_LAGS (PITCH_WINDOW / 2)
+
+static void load_frame(PitchTracker *p, const float ring[], size_t ring_size, size_t head) {
+    size_t start = head + ring_size - PITCH_WINDOW;
+    for (size_t i = 0; i < PITCH_WINDOW; ++i) {
+        p->frame[i] = ring[(start + i) % ring_size];
+    }
+    memset(p->frame + PITCH_WINDOW, 0, (PITCH_FFT - PITCH_WINDOW) * sizeof(p->frame[0]));
+}
+
+// Cumulative mean normalised difference, absolute threshold and parabolic
+// interpolation, steps 3 to 5 of the YIN paper.
+static void pick_period(PitchTracker *p, unsigned int sample_rate) {
+    float *d = p->diff;
+    float sum = 0.0f;
+    d[0] = 1.0f;
+    for (size_t tau = 1; tau < PITCH_LAGS; ++tau) {
+        sum += d[tau];
+        d[tau] = sum > 0 ? d[tau] * tau / sum : 1.0f;
+    }
+
+    size_t best = 0;
+    for (size_t tau = 2; tau < PITCH_LAGS; ++tau) {
+        if (d[tau] < PITCH_THRESHOLD) {
+            while (tau + 1 < PITCH_LAGS && d[tau + 1] < d[tau]) tau++;
+            best = tau;
+            break;
+        }
+    }
+    if (best == 0) {
+        p->f0 = 0.0f;
+        p->confidence = 0.0f;
+        return;
+    }
+
+    float period = best;
+    if (best + 1 < PITCH_LAGS) {
+        float a = d[best - 1];
+        float b = d[best];
+        float c = d[best + 1];
+        float denom = a - 2 * b + c;
+        if (denom > 0) period += 0.5f * (a - c) / denom;
+    }
+    p->f0 = sample_rate / period;
+    p->confidence = 1.0f - d[best];
+}
+
+bool pitch_init(PitchTracker *p) {
+    return fft_plan_init(&p->plan, PITCH_FFT, FFT_RADIX2);
+}
+
+void pitch_free(PitchTracker *p) {
+    fft_plan_free(&p->plan);
+}
+
+void pitch_update(PitchTracker *p, const float ring[], size_t ring_size, size_t head, unsigned int sample_rate) {
+    load_frame(p, ring, ring_size, head);
+
+    // autocorrelation: inverse transform of the power spectrum. The power
+    // spectrum is real and even, so a forward real transform does it too.
+    fft_plan_execute(&p->plan, p->frame, 1, p->spectrum);
+    for (size_t k = 0; k < PITCH_FFT; ++k) {
+        float re = crealf(p->spectrum[k]);
+        float im = cimagf(p->spectrum[k]);
+        p->power[k] = re * re + im * im;
+    }
+    fft_plan_execute(&p->plan, p->power, 1, p->spectrum);
+
+    // d(tau) = sum of x[j]^2 + x[j + tau]^2 over the overlap - 2 r(tau)
+    const float *x = p->frame;
+    double head_energy = 0.0;
+    double tail_energy = 0.0;
+    for (size_t j = 0; j < PITCH_WINDOW; ++j) head_energy += x[j] * x[j];
+    tail_energy = head_energy;
+    for (size_t tau = 0; tau < PITCH_LAGS; ++tau) {
+        float r = crealf(p->spectrum[tau]) / PITCH_FFT;
+        p->diff[tau] = fmaxf((float) (head_energy + tail_energy) - 2 * r, 0.0f);
+        head_energy -= x[PITCH_WINDOW - 1 - tau] * x[PITCH_WINDOW - 1 - tau];
+        tail_energy -= x[tau] * x[tau];
+    }
+
+    pick_period(p, sample_rate);
+}
+
+void pitch_update_naive(PitchTracker *p, const float ring[], size_t ring_size, size_t head, unsigned int sample_rate) {
+    load_frame(p, ring, ring_size, head);
+
+    const float *x = p->frame;
+    for (size_t tau = 0; tau < PITCH_LAGS; ++tau) {
+        float d = 0.0f;
+        for (size_t j = 0; j + tau < PITCH_WINDOW; ++j) {
+            float delta = x[j] - x[j + tau];
+            d += delta * delta;
+        }
+        p->diff[tau] = d;
+    }
+
+    pick_period(p, sample_rate);
+}
@@ -0,0 +1,39 @@
+#ifndef PITCH_H
+#define PITCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "fft.h"
+
+// Analysis window in samples; the longest detectable period is half of it,
+// about 43 Hz at 44.1 kHz.
+#define PITCH_WINDOW 2048
+// Zero padded transform length, large enough for a linear autocorrelation.
+#define PITCH_FFT (2 * PITCH_WINDOW)
+#define PITCH_THRESHOLD 0.15f
+
+// Monophonic YIN pitch detector. The difference function is built from an
+// autocorrelation computed with an FFT plan instead of the O(N^2) lag loop.
+typedef struct {
+    float f0;         // Hz, 0 when unvoiced
+    float confidence; // 1 - aperiodicity of the chosen period
+
+    FftPlan plan; // PITCH_FFT points
+
+    // scratch, preallocated
+    float frame[PITCH_FFT];
+    float power[PITCH_FFT];
+    Float_Complex spectrum[PITCH_FFT];
+    float diff[PITCH_WINDOW / 2];
+} PitchTracker;
+
+bool pitch_init(PitchTracker *p);
+void pitch_free(PitchTracker *p);
+// Runs on the newest PITCH_WINDOW samples of a ring of ring_size samples
+// whose oldest sample is at head.
+void pitch_update(PitchTracker *p, const float ring[], size_t ring_size, size_t head, unsigned int sample_rate);
+// Same detector with the difference function computed directly, kept as
+// the reference for --bench pitch.
+void pitch_update_naive(PitchTracker *p, const float ring[], size_t ring_size, size_t head, unsigned int sample_rate);
+
+#endif // PITCH_H
@@ -0,0 +1,109 @@
+#include <stdlib.h>
+#include <string.h>
+#include <raylib.h>
+#include "record.h"
+
+static bool ends_with(const char *s, const char *suffix) {
+    size_t n = strlen(s);
+    size_t k = strlen(suffix);
+    return n >= k && strcmp(s + n - k, suffix) == 0;
+}
+
+bool recorder_open(Recorder *r, const char *path, int width, int height, int fps) {
+    *r = (Recorder) {
+            .path = path,
+            .width = width,
+            .height = height,
+            .fps = fps,
+    };
+
+    size_t pixels = (size_t) width * height;
+    if (ends_with(path, ".y4m")) {
+        r->format = RECORD_Y4M;
+        r->file = fopen(path, "wb");
+        if (r->file == NULL) {
+            TraceLog(LOG_ERROR, "RECORD: Could not open %s", path);
+            return false;
+        }
+        // frames are large, let stdio hand them to the kernel in big chunks
+        setvbuf(r->file, NULL, _IOFBF, 1 << 20);
+        fprintf(r->file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", width, height, fps);
+        r->scratch = malloc(pixels * 3);
+    } else if (strchr(path, '%') != NULL) {
+        r->format = RECORD_PNG;
+        r->scratch = malloc(pixels * 4);
+    } else {
+        TraceLog(LOG_ERROR, "RECORD: %s is neither a .y4m file nor a frame pattern like out/%%05d.png", path);
+        return false;
+    }
+
+    if (r->scratch == NULL) {
+        recorder_close(r);
+        return false;
+    }
+    return true;
+}
+
+// BT.601 limited range, the colorspace players assume for untagged Y4M.
+static void write_y4m(Recorder *r, const unsigned char *rgba) {
+    size_t pixels = (size_t) r->width * r->height;
+    unsigned char *py = r->scratch;
+    unsigned char *pu = py + pixels;
+    unsigned char *pv = pu + pixels;
+
+    for (int y = 0; y < r->height; ++y) {
+        const unsigned char *row = rgba + (size_t) (r->height - 1 - y) * r->width * 4;
+        for (int x = 0; x < r->width; ++x) {
+            int R = row[x * 4 + 0];
+            int G = row[x * 4 + 1];
+            int B = row[x * 4 + 2];
+            *py++ = (unsigned char) (((66 * R + 129 * G + 25 * B + 128) >> 8) + 16);
+            *pu++ = (unsigned char) (((-38 * R - 74 * G + 112 * B + 128) >> 8) + 128);
+            *pv++ = (unsigned char) (((112 * R - 94 * G - 18 * B + 128) >> 8) + 128);
+        }
+    }
+
+    fputs("FRAME\n", r->file);
+    fwrite(r->scratch, 1, pixels * 3, r->file);
+}
+
+static bool write_png(Recorder *r, const unsigned char *rgba) {
+    size_t stride = (size_t) r->width * 4;
+    for (int y = 0; y < r->height; ++y) {
+        unsigned char *dst = r->scratch + (size_t) y * stride;
+        memcpy(dst, rgba + (size_t) (r->height - 1 - y) * stride, stride);
+        // blending leaves partial alpha in the framebuffer, the video is opaque
+        for (size_t x = 3; x < stride; x += 4) dst[x] = 255;
+    }
+
+    Image image = {
+            .data = r->scratch,
+            .width = r->width,
+            .height = r->height,
+            .mipmaps = 1,
+            .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
+    };
+    return ExportImage(image, TextFormat(r->path, (int) r->frame));
+}
+
+bool recorder_write(Recorder *r, const unsigned char *rgba) {
+    bool ok = true;
+    switch (r->format) {
+        case RECORD_Y4M:
+            write_y4m(r, rgba);
+            ok = !ferror(r->file);
+            break;
+        case RECORD_PNG:
+            ok = write_png(r, rgba);
+            break;
+    }
+    r->frame++;
+    return ok;
+}
+
+void recorder_close(Recorder *r) {
+    if (r->file != NULL) fclose(r->file);
+    free(r->scratch);
+    r->file = NULL;
+    r->scratch = NULL;
+}
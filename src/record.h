@@ -0,0 +1,33 @@
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stddef.h>
+
+// Output container, picked from the path given to recorder_open():
+// "*.y4m" streams raw YUV 4:4:4 frames, anything containing a printf
+// integer conversion (e.g. "frames/%05d.png") writes a PNG per frame.
+typedef enum {
+    RECORD_Y4M,
+    RECORD_PNG,
+} RecordFormat;
+
+typedef struct {
+    RecordFormat format;
+    const char *path;
+    FILE *file;
+    int width;
+    int height;
+    int fps;
+    size_t frame;
+    unsigned char *scratch;
+} Recorder;
+
+bool recorder_open(Recorder *r, const char *path, int width, int height, int fps);
+// rgba holds width * height RGBA8 pixels as read back from OpenGL, that is
+// bottom row first.
+bool recorder_write(Recorder *r, const unsigned char *rgba);
+void recorder_close(Recorder *r);
+
+#endif // RECORD_H
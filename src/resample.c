@@ -0,0 +1,114 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "resample.h"
+#include "simd.h"
+
+static uint64_t gcd(uint64_t a, uint64_t b) {
+    while (b != 0) {
+        uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static double blackman(double d) {
+    double x = M_PI * d / (RESAMPLE_TAPS / 2);
+    return 0.42 + 0.5 * cos(x) + 0.08 * cos(2 * x);
+}
+
+bool resampler_init(Resampler *r, unsigned int in_rate, unsigned int out_rate) {
+    memset(r, 0, sizeof(*r));
+    r->in_rate = in_rate;
+    r->out_rate = out_rate;
+    if (in_rate == out_rate || in_rate == 0 || out_rate == 0) return in_rate == out_rate;
+
+    uint64_t g = gcd(in_rate, out_rate);
+    r->up = out_rate / g;
+    r->down = in_rate / g;
+    r->phases = r->up <= RESAMPLE_MAX_PHASES ? r->up : RESAMPLE_MAX_PHASES;
+    r->out_capacity = (RESAMPLE_TAPS + RESAMPLE_CHUNK) * r->up / r->down + 2;
+    r->taps = malloc(sizeof(float) * r->phases * RESAMPLE_TAPS);
+    r->out = malloc(sizeof(float) * r->out_capacity);
+    if (r->taps == NULL || r->out == NULL) {
+        resampler_free(r);
+        return false;
+    }
+
+    // cutoff in cycles per input sample, the transition band of the window
+    // ends at the lower Nyquist rate
+    double ratio = out_rate < in_rate ? (double) out_rate / in_rate : 1.0;
+    double cutoff = 0.5 * ratio - 2.75 / RESAMPLE_TAPS;
+    for (size_t p = 0; p < r->phases; ++p) {
+        float *h = r->taps + p * RESAMPLE_TAPS;
+        double f = (double) p / r->phases;
+        double sum = 0.0;
+        for (size_t j = 0; j < RESAMPLE_TAPS; ++j) {
+            // distance of input j from the output, which sits f past the middle
+            double d = (double) j - (RESAMPLE_TAPS / 2 - 1) - f;
+            double x = 2 * cutoff * d;
+            double sinc = x == 0.0 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+            h[j] = (float) (sinc * blackman(d));
+            sum += h[j];
+        }
+        // unity gain at DC for every phase
+        for (size_t j = 0; j < RESAMPLE_TAPS; ++j) h[j] = (float) (h[j] / sum);
+    }
+    return true;
+}
+
+static float dot(const float *h, const float *x) {
+    v4sf a0 = v4sf_splat(0.0f), a1 = a0, a2 = a0, a3 = a0;
+    for (size_t j = 0; j < RESAMPLE_TAPS; j += 16) {
+        a0 += v4sf_load(h + j) * v4sf_load(x + j);
+        a1 += v4sf_load(h + j + 4) * v4sf_load(x + j + 4);
+        a2 += v4sf_load(h + j + 8) * v4sf_load(x + j + 8);
+        a3 += v4sf_load(h + j + 12) * v4sf_load(x + j + 12);
+    }
+    v4sf a = (a0 + a1) + (a2 + a3);
+    return (a[0] + a[1]) + (a[2] + a[3]);
+}
+
+size_t resampler_process(Resampler *r, const float *in, size_t count, size_t stride, const float **out,
+                         size_t *produced) {
+    if (count > RESAMPLE_CHUNK) count = RESAMPLE_CHUNK;
+    for (size_t i = 0; i < count; ++i) r->history[r->filled + i] = in[i * stride];
+    r->filled += count;
+
+    size_t n = 0;
+    for (;;) {
+        uint64_t start = r->frac / r->up;
+        uint64_t phase = r->frac % r->up;
+        if (r->phases != r->up) {
+            // the nearest filter; rounding up past the last is the first one
+            // of the next input sample
+            phase = (phase * r->phases + r->up / 2) / r->up;
+            if (phase == r->phases) {
+                phase = 0;
+                start++;
+            }
+        }
+        if (start + RESAMPLE_TAPS > r->filled) break;
+        r->out[n++] = dot(r->taps + phase * RESAMPLE_TAPS, r->history + start);
+        r->frac += r->down;
+    }
+
+    // drop the input no later output reaches
+    uint64_t start = r->frac / r->up;
+    size_t drop = start < r->filled ? (size_t) start : r->filled;
+    memmove(r->history, r->history + drop, (r->filled - drop) * sizeof(float));
+    r->filled -= drop;
+    r->frac -= (uint64_t) drop * r->up;
+
+    *out = r->out;
+    *produced = n;
+    return count;
+}
+
+void resampler_free(Resampler *r) {
+    free(r->taps);
+    free(r->out);
+    r->taps = NULL;
+    r->out = NULL;
+}
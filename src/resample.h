@@ -0,0 +1,48 @@
+#ifndef RESAMPLE_H
+#define RESAMPLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Taps per phase, a multiple of 4.
+#define RESAMPLE_TAPS 64
+// More phases than this share the nearest of RESAMPLE_MAX_PHASES filters.
+#define RESAMPLE_MAX_PHASES 512
+// Input frames taken per call.
+#define RESAMPLE_CHUNK 1024
+
+// Polyphase windowed-sinc resampler for one channel. out_rate / in_rate is
+// reduced to up / down; output k lands up / down input samples after output
+// k - 1, and each of the up phases between two input samples has its own
+// Blackman windowed sinc, low-passed below the lower of the two Nyquist
+// rates. Ratios with more than RESAMPLE_MAX_PHASES phases keep the exact
+// rate and round the phase.
+typedef struct {
+    unsigned int in_rate;
+    unsigned int out_rate;
+    uint64_t up;
+    uint64_t down;
+    size_t phases;
+    float *taps;      // phases * RESAMPLE_TAPS
+    float *out;
+    size_t out_capacity;
+
+    float history[RESAMPLE_TAPS + RESAMPLE_CHUNK];
+    size_t filled;
+    uint64_t frac;    // next output is frac / up input samples past history[0]
+} Resampler;
+
+// Equal rates need no filter, resampler_process is not to be called then.
+bool resampler_init(Resampler *r, unsigned int in_rate, unsigned int out_rate);
+static inline bool resampler_active(const Resampler *r) {
+    return r->taps != NULL;
+}
+// Takes channel 0 of up to RESAMPLE_CHUNK interleaved frames at stride,
+// returns how many it took. *out points at the *produced output samples
+// until the next call.
+size_t resampler_process(Resampler *r, const float *in, size_t count, size_t stride, const float **out,
+                         size_t *produced);
+void resampler_free(Resampler *r);
+
+#endif // RESAMPLE_H
@@ -0,0 +1,103 @@
+#include <string.h>
+#include <raylib.h>
+#include "shm_publish.h"
+
+#ifndef _WIN32
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+bool shm_publish_open(ShmPublisher *p, const char *name, unsigned int sample_rate, size_t fft_size) {
+    *p = (ShmPublisher) { .name = name };
+
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        TraceLog(LOG_ERROR, "SHM: Could not open %s", name);
+        return false;
+    }
+    if (ftruncate(fd, sizeof(SpectrumShm)) != 0) {
+        TraceLog(LOG_ERROR, "SHM: Could not size %s", name);
+        close(fd);
+        return false;
+    }
+    void *map = mmap(NULL, sizeof(SpectrumShm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        TraceLog(LOG_ERROR, "SHM: Could not map %s", name);
+        return false;
+    }
+
+    p->shm = map;
+    SpectrumShm *shm = p->shm;
+    // a stale segment may have readers attached, keep its sequence running
+    uint64_t sequence = atomic_load_explicit(&shm->sequence, memory_order_relaxed);
+    atomic_store_explicit(&shm->sequence, sequence | 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    shm->magic = SPECTRUM_SHM_MAGIC;
+    shm->version = SPECTRUM_SHM_VERSION;
+    shm->size = sizeof(SpectrumShm);
+    shm->max_bands = SPECTRUM_SHM_MAX_BANDS;
+    memset(&shm->frame, 0, sizeof(shm->frame));
+    shm->frame.sample_rate = sample_rate;
+    shm->frame.fft_size = (uint32_t) fft_size;
+    atomic_store_explicit(&shm->sequence, (sequence | 1) + 1, memory_order_release);
+
+    TraceLog(LOG_INFO, "SHM: Publishing spectrum in %s", name);
+    return true;
+}
+
+void shm_publish(ShmPublisher *p, double time, const size_t band_edge[], const float smooth[], size_t bands) {
+    SpectrumShm *shm = p->shm;
+    if (shm == NULL) return;
+    if (bands > SPECTRUM_SHM_MAX_BANDS) bands = SPECTRUM_SHM_MAX_BANDS;
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    uint64_t sequence = atomic_load_explicit(&shm->sequence, memory_order_relaxed);
+    atomic_store_explicit(&shm->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    SpectrumFrame *frame = &shm->frame;
+    frame->frame = p->frame++;
+    frame->time = time;
+    frame->wall_ns = (int64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+    frame->bands = (uint32_t) bands;
+    for (size_t i = 0; i <= bands; ++i) frame->band_edge[i] = (uint32_t) band_edge[i];
+    memcpy(frame->smooth, smooth, bands * sizeof(smooth[0]));
+
+    atomic_store_explicit(&shm->sequence, sequence + 2, memory_order_release);
+}
+
+void shm_publish_close(ShmPublisher *p) {
+    if (p->shm == NULL) return;
+    munmap(p->shm, sizeof(SpectrumShm));
+    shm_unlink(p->name);
+    p->shm = NULL;
+}
+
+#else
+
+bool shm_publish_open(ShmPublisher *p, const char *name, unsigned int sample_rate, size_t fft_size) {
+    (void) sample_rate;
+    (void) fft_size;
+    *p = (ShmPublisher) { .name = name };
+    TraceLog(LOG_WARNING, "SHM: Shared memory publishing needs POSIX shared memory");
+    return false;
+}
+
+void shm_publish(ShmPublisher *p, double time, const size_t band_edge[], const float smooth[], size_t bands) {
+    (void) p;
+    (void) time;
+    (void) band_edge;
+    (void) smooth;
+    (void) bands;
+}
+
+void shm_publish_close(ShmPublisher *p) {
+    (void) p;
+}
+
+#endif
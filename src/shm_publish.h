@@ -0,0 +1,21 @@
+#ifndef SHM_PUBLISH_H
+#define SHM_PUBLISH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "spectrum_shm.h"
+
+typedef struct {
+    const char *name;
+    SpectrumShm *shm;
+    uint64_t frame;
+} ShmPublisher;
+
+// Creates (or takes over) the segment. Not available on Windows.
+bool shm_publish_open(ShmPublisher *p, const char *name, unsigned int sample_rate, size_t fft_size);
+// Never blocks: readers detect a concurrent write through the seqlock.
+void shm_publish(ShmPublisher *p, double time, const size_t band_edge[], const float smooth[], size_t bands);
+// Unmaps and unlinks the segment.
+void shm_publish_close(ShmPublisher *p);
+
+#endif // SHM_PUBLISH_H
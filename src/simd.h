@@ -0,0 +1,44 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <string.h>
+
+// Four float lanes through the GCC/Clang vector extension, lowered to SSE on
+// x86 and NEON on ARM without intrinsics.
+typedef float v4sf __attribute__((vector_size(16)));
+// Comparisons of v4sf yield all-ones / all-zeros lanes of this type.
+typedef int v4si __attribute__((vector_size(16)));
+// Four int16 lanes, half a register, for widening PCM samples.
+typedef short v4hi __attribute__((vector_size(8)));
+
+static inline v4sf v4sf_splat(float x) {
+    return (v4sf) { x, x, x, x };
+}
+
+static inline v4sf v4sf_load(const float *p) {
+    v4sf v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void v4sf_store(float *p, v4sf v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+// Lanes of a where mask is set, of b elsewhere.
+static inline v4sf v4sf_select(v4si mask, v4sf a, v4sf b) {
+    return (v4sf) (((v4si) a & mask) | ((v4si) b & ~mask));
+}
+
+// Four int16 from p, unaligned, as floats.
+static inline v4sf v4sf_load_s16(const short *p) {
+    v4hi v;
+    memcpy(&v, p, sizeof(v));
+    return __builtin_convertvector(v, v4sf);
+}
+
+static inline v4sf v4sf_max(v4sf a, v4sf b) {
+    return v4sf_select(a > b, a, b);
+}
+
+#endif // SIMD_H
@@ -0,0 +1,250 @@
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "spectrogram.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define ALIGN8(x) (((x) + 7) & ~(size_t) 7)
+
+typedef struct {
+    uint32_t id;
+    uint32_t reserved;
+    uint64_t size;
+} ChunkHeader;
+
+static bool write_chunk(SpectrogramWriter *w, uint32_t id, uint64_t size) {
+    ChunkHeader chunk = { .id = id, .size = size };
+    return fwrite(&chunk, sizeof(chunk), 1, w->file) == 1;
+}
+
+static bool write_padding(SpectrogramWriter *w, size_t size) {
+    static const unsigned char zero[8] = { 0 };
+    size_t pad = ALIGN8(size) - size;
+    return pad == 0 || fwrite(zero, 1, pad, w->file) == pad;
+}
+
+// HEAD, BAND and the start of FRMS, once the band count is known.
+static bool write_layout(SpectrogramWriter *w, const size_t band_edge[], size_t bands) {
+    w->header.bands = (uint32_t) bands;
+    w->header.frame_size = (uint32_t) ALIGN8(offsetof(SpectrogramFrame, levels) + bands * sizeof(float));
+    w->record = calloc(1, w->header.frame_size);
+    if (w->record == NULL) return false;
+
+    if (!write_chunk(w, SPECTROGRAM_HEAD, sizeof(w->header))) return false;
+    w->head_offset = ftell(w->file);
+    if (fwrite(&w->header, sizeof(w->header), 1, w->file) != 1) return false;
+
+    size_t edges = bands + 1;
+    if (!write_chunk(w, SPECTROGRAM_BAND, edges * sizeof(uint32_t))) return false;
+    for (size_t i = 0; i < edges; ++i) {
+        uint32_t edge = band_edge != NULL ? (uint32_t) band_edge[i] : 0;
+        if (fwrite(&edge, sizeof(edge), 1, w->file) != 1) return false;
+    }
+    if (!write_padding(w, edges * sizeof(uint32_t))) return false;
+
+    if (!write_chunk(w, SPECTROGRAM_FRMS, SPECTROGRAM_UNFINISHED)) return false;
+    w->frames_offset = ftell(w->file);
+    return w->head_offset >= 0 && w->frames_offset >= 0;
+}
+
+bool spectrogram_writer_open(SpectrogramWriter *w, const char *path, unsigned int sample_rate,
+                             unsigned int fft_size, unsigned int frame_rate) {
+    *w = (SpectrogramWriter) { 0 };
+    w->header.sample_rate = sample_rate;
+    w->header.fft_size = fft_size;
+    w->header.frame_rate = frame_rate;
+
+    w->file = fopen(path, "wb");
+    if (w->file == NULL) return false;
+    uint32_t file_header[2] = { SPECTROGRAM_MAGIC, SPECTROGRAM_VERSION };
+    if (fwrite(file_header, sizeof(file_header), 1, w->file) != 1) {
+        fclose(w->file);
+        w->file = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool spectrogram_writer_write(SpectrogramWriter *w, const SpectrogramFrame *frame, const float levels[],
+                              const size_t band_edge[], size_t bands) {
+    if (w->file == NULL || w->failed) return false;
+    if (w->record == NULL) {
+        w->header.first_time = frame->time;
+        if (!write_layout(w, band_edge, bands)) {
+            w->failed = true;
+            return false;
+        }
+    }
+    if (bands != w->header.bands) {
+        w->failed = true;
+        return false;
+    }
+
+    if (w->header.frame_count == w->capacity) {
+        size_t capacity = w->capacity ? 2 * w->capacity : 4096;
+        double *times = realloc(w->times, capacity * sizeof(double));
+        if (times == NULL) {
+            w->failed = true;
+            return false;
+        }
+        w->times = times;
+        w->capacity = capacity;
+    }
+    w->times[w->header.frame_count++] = frame->time;
+
+    memcpy(w->record, frame, offsetof(SpectrogramFrame, levels));
+    memcpy(w->record->levels, levels, bands * sizeof(float));
+    if (fwrite(w->record, w->header.frame_size, 1, w->file) != 1) w->failed = true;
+    return !w->failed;
+}
+
+bool spectrogram_writer_close(SpectrogramWriter *w) {
+    if (w->file == NULL) return false;
+    bool ok = !w->failed;
+    if (ok && w->record == NULL) ok = write_layout(w, NULL, 0);
+
+    if (ok) {
+        uint64_t frames_size = (uint64_t) w->header.frame_count * w->header.frame_size;
+        uint64_t index_size = (uint64_t) w->header.frame_count * sizeof(double);
+        ok = write_chunk(w, SPECTROGRAM_INDX, index_size)
+             && (w->header.frame_count == 0
+                 || fwrite(w->times, sizeof(double), w->header.frame_count, w->file) == w->header.frame_count)
+             // patch the counts last, a crash before leaves a readable unfinished file
+             && fseek(w->file, w->frames_offset - (long) sizeof(uint64_t), SEEK_SET) == 0
+             && fwrite(&frames_size, sizeof(frames_size), 1, w->file) == 1
+             && fseek(w->file, w->head_offset, SEEK_SET) == 0
+             && fwrite(&w->header, sizeof(w->header), 1, w->file) == 1;
+    }
+    if (fclose(w->file) != 0) ok = false;
+    free(w->record);
+    free(w->times);
+    *w = (SpectrogramWriter) { 0 };
+    return ok;
+}
+
+#ifdef _WIN32
+
+static void *map_file(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+    void *data = NULL;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long end = ftell(file);
+        if (end > 0 && fseek(file, 0, SEEK_SET) == 0) {
+            data = malloc(end);
+            if (data != NULL && fread(data, 1, end, file) != (size_t) end) {
+                free(data);
+                data = NULL;
+            }
+            *size = end;
+        }
+    }
+    fclose(file);
+    return data;
+}
+
+static void unmap_file(void *map, size_t size) {
+    (void) size;
+    free(map);
+}
+
+#else
+
+static void *map_file(const char *path, size_t *size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        *size = st.st_size;
+        map = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+    // readers seek around, do not read ahead megabytes they skip
+    madvise(map, *size, MADV_RANDOM);
+    return map;
+}
+
+static void unmap_file(void *map, size_t size) {
+    munmap(map, size);
+}
+
+#endif
+
+bool spectrogram_open(Spectrogram *s, const char *path) {
+    *s = (Spectrogram) { 0 };
+    s->map = map_file(path, &s->map_size);
+    if (s->map == NULL) return false;
+
+    const unsigned char *base = s->map;
+    const uint32_t *file_header = s->map;
+    if (s->map_size < 8 || file_header[0] != SPECTROGRAM_MAGIC || file_header[1] != SPECTROGRAM_VERSION) {
+        spectrogram_close(s);
+        return false;
+    }
+
+    uint64_t band_size = 0;
+    uint64_t frames_size = 0;
+    uint64_t index_size = 0;
+    size_t offset = 8;
+    while (offset + sizeof(ChunkHeader) <= s->map_size) {
+        ChunkHeader chunk;
+        memcpy(&chunk, base + offset, sizeof(chunk));
+        size_t payload = offset + sizeof(chunk);
+        uint64_t available = s->map_size - payload;
+        if (chunk.id == SPECTROGRAM_FRMS && chunk.size == SPECTROGRAM_UNFINISHED) chunk.size = available;
+        if (chunk.size > available) break;
+
+        if (chunk.id == SPECTROGRAM_HEAD && chunk.size >= sizeof(SpectrogramHeader)) {
+            s->header = (const SpectrogramHeader *) (base + payload);
+        } else if (chunk.id == SPECTROGRAM_BAND) {
+            s->band_edge = (const uint32_t *) (base + payload);
+            band_size = chunk.size;
+        } else if (chunk.id == SPECTROGRAM_FRMS) {
+            s->frames = base + payload;
+            frames_size = chunk.size;
+        } else if (chunk.id == SPECTROGRAM_INDX) {
+            s->index = (const double *) (base + payload);
+            index_size = chunk.size;
+        }
+        offset = payload + ALIGN8(chunk.size);
+    }
+
+    const SpectrogramHeader *h = s->header;
+    if (h == NULL || s->band_edge == NULL || s->frames == NULL || h->frame_rate == 0
+        || band_size < ((uint64_t) h->bands + 1) * sizeof(uint32_t)
+        || h->frame_size % 8 != 0
+        || h->frame_size < offsetof(SpectrogramFrame, levels) + (uint64_t) h->bands * sizeof(float)) {
+        spectrogram_close(s);
+        return false;
+    }
+    s->count = frames_size / h->frame_size;
+    // an index that does not match the frames is as good as none
+    if (h->frame_count != s->count || index_size < s->count * sizeof(double)) s->index = NULL;
+    return true;
+}
+
+void spectrogram_close(Spectrogram *s) {
+    if (s->map != NULL) unmap_file(s->map, s->map_size);
+    *s = (Spectrogram) { 0 };
+}
+
+static double frame_time(const Spectrogram *s, size_t i) {
+    return s->index != NULL ? s->index[i] : spectrogram_frame(s, i)->time;
+}
+
+size_t spectrogram_find(const Spectrogram *s, double time) {
+    double position = floor((time - s->header->first_time) * s->header->frame_rate);
+    size_t i = position <= 0 ? 0 : position >= (double) (s->count - 1) ? s->count - 1 : (size_t) position;
+    // the clock is exact up to rounding, this moves at most a frame
+    while (i + 1 < s->count && frame_time(s, i + 1) <= time) i++;
+    while (i > 0 && frame_time(s, i) > time) i--;
+    return i;
+}
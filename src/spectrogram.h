@@ -0,0 +1,94 @@
+#ifndef SPECTROGRAM_H
+#define SPECTROGRAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Spectrogram files, native (little-endian) byte order. After an 8 byte file
+// header ("SPGM", version) come chunks of { u32 id, u32 reserved, u64 size,
+// payload }, every payload 8 byte aligned:
+//   HEAD  SpectrogramHeader
+//   BAND  u32 band_edge[bands + 1], first FFT bin of every band
+//   FRMS  frame_count records of frame_size bytes, each a SpectrogramFrame
+//   INDX  f64 time[frame_count], the frame times packed together
+// Frames are written on the fixed analysis clock, so a time maps straight to
+// a record; the index only corrects for rounding. A file whose writer died
+// has FRMS size SPECTROGRAM_UNFINISHED and no index, readers take every
+// whole record up to the end of the file.
+#define SPECTROGRAM_MAGIC 0x4d475053u // "SPGM"
+#define SPECTROGRAM_VERSION 1
+#define SPECTROGRAM_CHUNK(a, b, c, d) ((uint32_t) (a) | (uint32_t) (b) << 8 | (uint32_t) (c) << 16 | (uint32_t) (d) << 24)
+#define SPECTROGRAM_HEAD SPECTROGRAM_CHUNK('H', 'E', 'A', 'D')
+#define SPECTROGRAM_BAND SPECTROGRAM_CHUNK('B', 'A', 'N', 'D')
+#define SPECTROGRAM_FRMS SPECTROGRAM_CHUNK('F', 'R', 'M', 'S')
+#define SPECTROGRAM_INDX SPECTROGRAM_CHUNK('I', 'N', 'D', 'X')
+#define SPECTROGRAM_UNFINISHED UINT64_MAX
+
+typedef struct {
+    uint32_t sample_rate;
+    uint32_t fft_size;
+    uint32_t frame_rate;  // analysis steps per second
+    uint32_t bands;
+    uint32_t frame_size;  // bytes per record, a multiple of 8
+    uint32_t reserved;
+    double first_time;    // time of frame 0, later frames follow every 1 / frame_rate
+    uint64_t frame_count;
+} SpectrogramHeader;
+
+typedef struct {
+    double time;          // analysis clock at the end of the step, seconds
+    float flux;           // onset strength
+    uint32_t onset_band;  // band that contributed most flux
+    float f0;             // Hz, 0 when unvoiced
+    float confidence;
+    float chroma[12];
+    float levels[];       // bands log-power levels, 0..1 before smoothing
+} SpectrogramFrame;
+
+// Appends frames to a new file. The band layout is taken from the first
+// frame, the index and counts are filled in by spectrogram_writer_close.
+typedef struct {
+    FILE *file;
+    SpectrogramHeader header;
+    long head_offset;
+    long frames_offset;
+    SpectrogramFrame *record;
+    double *times;
+    size_t capacity;
+    bool failed;
+} SpectrogramWriter;
+
+bool spectrogram_writer_open(SpectrogramWriter *w, const char *path, unsigned int sample_rate,
+                             unsigned int fft_size, unsigned int frame_rate);
+// Everything but the levels comes from frame, levels and band_edge are as in
+// the analysis (bands + 1 edges).
+bool spectrogram_writer_write(SpectrogramWriter *w, const SpectrogramFrame *frame, const float levels[],
+                              const size_t band_edge[], size_t bands);
+// Writes the index and patches the counts, false if anything failed on the way.
+bool spectrogram_writer_close(SpectrogramWriter *w);
+
+// A spectrogram mapped read-only, frames are accessed in place.
+typedef struct {
+    void *map;
+    size_t map_size;
+    const SpectrogramHeader *header;
+    const uint32_t *band_edge;
+    const unsigned char *frames;
+    const double *index; // NULL for an unfinished file
+    size_t count;
+} Spectrogram;
+
+bool spectrogram_open(Spectrogram *s, const char *path);
+void spectrogram_close(Spectrogram *s);
+
+static inline const SpectrogramFrame *spectrogram_frame(const Spectrogram *s, size_t i) {
+    return (const SpectrogramFrame *) (s->frames + i * s->header->frame_size);
+}
+
+// The last frame at or before time (the first one for earlier times), O(1).
+// count must be nonzero.
+size_t spectrogram_find(const Spectrogram *s, double time);
+
+#endif // SPECTROGRAM_H
@@ -0,0 +1,61 @@
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "spectrum_reader.h"
+
+// Copies attempted before a read is reported as torn.
+#define SPECTRUM_READ_RETRIES 8
+
+bool spectrum_reader_open(SpectrumReader *r, const char *name) {
+    *r = (SpectrumReader) { 0 };
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(SpectrumShm)) {
+        close(fd);
+        return false;
+    }
+    void *map = mmap(NULL, sizeof(SpectrumShm), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+
+    const SpectrumShm *shm = map;
+    if (shm->magic != SPECTRUM_SHM_MAGIC || shm->version != SPECTRUM_SHM_VERSION
+        || shm->size != sizeof(SpectrumShm)) {
+        munmap(map, sizeof(SpectrumShm));
+        return false;
+    }
+    r->shm = shm;
+    return true;
+}
+
+SpectrumReadStatus spectrum_reader_read(SpectrumReader *r, SpectrumFrame *out) {
+    // the segment is mapped read-only, the atomic loads do not write
+    _Atomic uint64_t *sequence = (_Atomic uint64_t *) &r->shm->sequence;
+
+    for (int attempt = 0; attempt < SPECTRUM_READ_RETRIES; ++attempt) {
+        uint64_t before = atomic_load_explicit(sequence, memory_order_acquire);
+        if (before & 1) continue;
+        if (before == r->sequence) return SPECTRUM_READ_STALE;
+
+        memcpy(out, &r->shm->frame, sizeof(*out));
+        atomic_thread_fence(memory_order_acquire);
+
+        uint64_t after = atomic_load_explicit(sequence, memory_order_relaxed);
+        if (before == after) {
+            if (out->bands > SPECTRUM_SHM_MAX_BANDS) out->bands = SPECTRUM_SHM_MAX_BANDS;
+            r->sequence = before;
+            return SPECTRUM_READ_OK;
+        }
+    }
+    r->torn++;
+    return SPECTRUM_READ_TORN;
+}
+
+void spectrum_reader_close(SpectrumReader *r) {
+    if (r->shm != NULL) munmap((void *) r->shm, sizeof(SpectrumShm));
+    r->shm = NULL;
+}
@@ -0,0 +1,31 @@
+#ifndef SPECTRUM_READER_H
+#define SPECTRUM_READER_H
+
+#include <stdbool.h>
+#include "spectrum_shm.h"
+
+// Reader side of the shared memory spectrum, built as the standalone
+// spectrum_reader library for other processes. Reads never block or slow
+// down the visualizer.
+
+typedef enum {
+    SPECTRUM_READ_OK,
+    // nothing newer than the last frame read
+    SPECTRUM_READ_STALE,
+    // the writer kept overwriting the frame while it was copied
+    SPECTRUM_READ_TORN,
+} SpectrumReadStatus;
+
+typedef struct {
+    const SpectrumShm *shm;
+    uint64_t sequence;
+    uint64_t torn;
+} SpectrumReader;
+
+// Returns false if the segment does not exist or has another layout version.
+bool spectrum_reader_open(SpectrumReader *r, const char *name);
+// Copies the latest consistent frame into out.
+SpectrumReadStatus spectrum_reader_read(SpectrumReader *r, SpectrumFrame *out);
+void spectrum_reader_close(SpectrumReader *r);
+
+#endif // SPECTRUM_READER_H
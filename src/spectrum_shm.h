@@ -0,0 +1,39 @@
+#ifndef SPECTRUM_SHM_H
+#define SPECTRUM_SHM_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+// Layout of the shared memory segment the visualizer publishes its bands
+// into. Shared by the writer in shm_publish.c and the reader library; bump
+// SPECTRUM_SHM_VERSION on any change to the structs below.
+#define SPECTRUM_SHM_DEFAULT_NAME "/spectralizer"
+#define SPECTRUM_SHM_MAGIC 0x43455053u // "SPEC"
+#define SPECTRUM_SHM_VERSION 1
+#define SPECTRUM_SHM_MAX_BANDS 1024
+
+typedef struct {
+    uint64_t frame;         // analysis step counter
+    double time;            // analysis clock, seconds of audio
+    int64_t wall_ns;        // CLOCK_REALTIME when published
+    uint32_t sample_rate;
+    uint32_t fft_size;
+    uint32_t bands;
+    // band i covers FFT bins [band_edge[i], band_edge[i + 1])
+    uint32_t band_edge[SPECTRUM_SHM_MAX_BANDS + 1];
+    // smoothed level of every band, 0..1
+    float smooth[SPECTRUM_SHM_MAX_BANDS];
+} SpectrumFrame;
+
+// sequence is a seqlock: odd while the writer is inside frame. Readers copy
+// frame and retry when the sequence changed underneath them.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    uint32_t max_bands;
+    _Atomic uint64_t sequence;
+    SpectrumFrame frame;
+} SpectrumShm;
+
+#endif // SPECTRUM_SHM_H
@@ -0,0 +1,26 @@
+#ifndef STREAM_PROTO_H
+#define STREAM_PROTO_H
+
+#include <stdint.h>
+
+// Wire format of --stream. The server writes a sequence of records, each a
+// StreamRecordHeader followed by bands little-endian uint16 levels (0..65535
+// for 0..1). Subscribers never send anything. A gap in frame means the
+// subscriber was too slow and the server dropped frames for it.
+#define STREAM_MAGIC 0x52465053u // "SPFR"
+#define STREAM_VERSION 1
+#define STREAM_MAX_BANDS 1024
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t bands;
+    uint32_t size;   // whole record in bytes, header included
+    uint32_t reserved;
+    uint64_t frame;
+    double time;
+} StreamRecordHeader;
+
+#define STREAM_MAX_RECORD (sizeof(StreamRecordHeader) + STREAM_MAX_BANDS * sizeof(uint16_t))
+
+#endif // STREAM_PROTO_H
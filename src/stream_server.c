@@ -0,0 +1,252 @@
+#include <string.h>
+#include <stdlib.h>
+#include <raylib.h>
+#include "stream_server.h"
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define TOKEN_LISTEN UINT64_MAX
+#define TOKEN_WAKE (UINT64_MAX - 1)
+
+static void watch(StreamServer *s, int fd, uint32_t events, uint64_t token, int op) {
+    struct epoll_event ev = { .events = events, .data.u64 = token };
+    epoll_ctl(s->epoll_fd, op, fd, &ev);
+}
+
+static void drop_subscriber(StreamServer *s, size_t i) {
+    StreamSubscriber *sub = &s->subscribers[i];
+    epoll_ctl(s->epoll_fd, EPOLL_CTL_DEL, sub->fd, NULL);
+    close(sub->fd);
+
+    // keep the array dense, the moved subscriber gets its new index as token
+    size_t last = --s->count;
+    if (i != last) {
+        s->subscribers[i] = s->subscribers[last];
+        uint32_t events = EPOLLIN | (s->subscribers[i].pending_size ? EPOLLOUT : 0);
+        watch(s, s->subscribers[i].fd, events, i, EPOLL_CTL_MOD);
+    }
+}
+
+// Returns false when the subscriber is gone.
+static bool flush_pending(StreamServer *s, size_t i) {
+    StreamSubscriber *sub = &s->subscribers[i];
+    while (sub->pending_sent < sub->pending_size) {
+        ssize_t n = send(sub->fd, sub->pending + sub->pending_sent, sub->pending_size - sub->pending_sent,
+                         MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        sub->pending_sent += n;
+    }
+    sub->pending_size = 0;
+    sub->pending_sent = 0;
+    watch(s, sub->fd, EPOLLIN, i, EPOLL_CTL_MOD);
+    return true;
+}
+
+static void broadcast(StreamServer *s, const StreamRecord *record) {
+    for (size_t i = 0; i < s->count;) {
+        StreamSubscriber *sub = &s->subscribers[i];
+        if (sub->pending_size) {
+            sub->dropped++;
+            i++;
+            continue;
+        }
+
+        // straight from the shared record, no copy unless the socket is full
+        ssize_t n = send(sub->fd, record->data, record->size, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            drop_subscriber(s, i);
+            continue;
+        }
+        if (n <= 0) {
+            sub->dropped++;
+        } else if ((size_t) n < record->size) {
+            sub->pending_size = record->size - n;
+            memcpy(sub->pending, record->data + n, sub->pending_size);
+            watch(s, sub->fd, EPOLLIN | EPOLLOUT, i, EPOLL_CTL_MOD);
+        }
+        i++;
+    }
+    s->sent++;
+}
+
+static void accept_subscribers(StreamServer *s) {
+    for (;;) {
+        int fd = accept(s->listen_fd, NULL, NULL);
+        if (fd < 0) return;
+        if (s->count == STREAM_MAX_SUBSCRIBERS) {
+            close(fd);
+            continue;
+        }
+        s->subscribers[s->count] = (StreamSubscriber) { .fd = fd };
+        watch(s, fd, EPOLLIN, s->count, EPOLL_CTL_ADD);
+        s->count++;
+    }
+}
+
+static void *serve(void *arg) {
+    StreamServer *s = arg;
+    struct epoll_event events[64];
+
+    while (atomic_load_explicit(&s->running, memory_order_relaxed)) {
+        int n = epoll_wait(s->epoll_fd, events, 64, 100);
+        for (int e = 0; e < n; ++e) {
+            uint64_t token = events[e].data.u64;
+            if (token == TOKEN_LISTEN) {
+                accept_subscribers(s);
+            } else if (token == TOKEN_WAKE) {
+                uint64_t count;
+                if (read(s->wake_fd, &count, sizeof(count)) < 0) continue;
+                size_t tail = atomic_load_explicit(&s->tail, memory_order_relaxed);
+                size_t head = atomic_load_explicit(&s->head, memory_order_acquire);
+                for (; tail != head; ++tail) broadcast(s, &s->records[tail % STREAM_RECORDS]);
+                atomic_store_explicit(&s->tail, tail, memory_order_release);
+            } else if (token < s->count) {
+                size_t i = token;
+                bool alive = !(events[e].events & (EPOLLHUP | EPOLLERR));
+                if (alive && (events[e].events & EPOLLIN)) {
+                    // subscribers have nothing to say, read to notice EOF
+                    unsigned char sink[256];
+                    ssize_t got = recv(s->subscribers[i].fd, sink, sizeof(sink), MSG_DONTWAIT);
+                    alive = got > 0 || (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+                }
+                if (alive && (events[e].events & EPOLLOUT)) alive = flush_pending(s, i);
+                // a removal reorders the array, tokens later in this batch
+                // may be stale; they are revalidated on the next wakeup
+                if (!alive) {
+                    drop_subscriber(s, i);
+                    break;
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+bool stream_server_start(StreamServer *s, const char *path) {
+    memset(s, 0, sizeof(*s));
+    s->path = path;
+    s->listen_fd = -1;
+    s->epoll_fd = -1;
+    s->wake_fd = -1;
+
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        TraceLog(LOG_ERROR, "STREAM: Socket path %s is too long", path);
+        return false;
+    }
+    strcpy(addr.sun_path, path);
+    unlink(path);
+
+    s->subscribers = calloc(STREAM_MAX_SUBSCRIBERS, sizeof(StreamSubscriber));
+    s->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    s->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    s->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (s->subscribers == NULL || s->listen_fd < 0 || s->epoll_fd < 0 || s->wake_fd < 0
+        || bind(s->listen_fd, (struct sockaddr *) &addr, sizeof(addr)) != 0
+        || listen(s->listen_fd, 512) != 0) {
+        TraceLog(LOG_ERROR, "STREAM: Could not listen on %s", path);
+        stream_server_stop(s);
+        return false;
+    }
+
+    watch(s, s->listen_fd, EPOLLIN, TOKEN_LISTEN, EPOLL_CTL_ADD);
+    watch(s, s->wake_fd, EPOLLIN, TOKEN_WAKE, EPOLL_CTL_ADD);
+    atomic_store(&s->running, true);
+    if (pthread_create(&s->thread, NULL, serve, s) != 0) {
+        TraceLog(LOG_ERROR, "STREAM: Could not start the server thread");
+        atomic_store(&s->running, false);
+        stream_server_stop(s);
+        return false;
+    }
+    TraceLog(LOG_INFO, "STREAM: Serving band frames on %s", path);
+    return true;
+}
+
+void stream_server_publish(StreamServer *s, uint64_t frame, double time, const float levels[], size_t bands) {
+    if (!atomic_load_explicit(&s->running, memory_order_relaxed)) return;
+
+    size_t head = atomic_load_explicit(&s->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&s->tail, memory_order_acquire);
+    if (head - tail == STREAM_RECORDS) {
+        atomic_fetch_add_explicit(&s->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    if (bands > STREAM_MAX_BANDS) bands = STREAM_MAX_BANDS;
+    StreamRecord *record = &s->records[head % STREAM_RECORDS];
+    StreamRecordHeader header = {
+            .magic = STREAM_MAGIC,
+            .version = STREAM_VERSION,
+            .bands = (uint16_t) bands,
+            .size = (uint32_t) (sizeof(header) + bands * sizeof(uint16_t)),
+            .frame = frame,
+            .time = time,
+    };
+    memcpy(record->data, &header, sizeof(header));
+    uint16_t *out = (uint16_t *) (record->data + sizeof(header));
+    for (size_t i = 0; i < bands; ++i) {
+        float v = levels[i] < 0.0f ? 0.0f : levels[i] > 1.0f ? 1.0f : levels[i];
+        out[i] = (uint16_t) (v * 65535.0f + 0.5f);
+    }
+    record->size = header.size;
+    atomic_store_explicit(&s->head, head + 1, memory_order_release);
+
+    uint64_t one = 1;
+    if (write(s->wake_fd, &one, sizeof(one)) < 0) {
+        // the counter only saturates if the server is long gone
+    }
+}
+
+void stream_server_stop(StreamServer *s) {
+    // zero initialised and never started, fd 0 is not the server's
+    if (s->path == NULL) return;
+    if (atomic_exchange(&s->running, false)) {
+        pthread_join(s->thread, NULL);
+        uint64_t dropped = 0;
+        for (size_t i = 0; i < s->count; ++i) dropped += s->subscribers[i].dropped;
+        TraceLog(LOG_INFO, "STREAM: %llu frames sent, %llu dropped before fan-out, %llu dropped for current subscribers",
+                 (unsigned long long) s->sent, (unsigned long long) s->dropped, (unsigned long long) dropped);
+    }
+    for (size_t i = 0; i < s->count; ++i) close(s->subscribers[i].fd);
+    s->count = 0;
+    free(s->subscribers);
+    s->subscribers = NULL;
+    if (s->wake_fd >= 0) close(s->wake_fd);
+    if (s->epoll_fd >= 0) close(s->epoll_fd);
+    if (s->listen_fd >= 0) {
+        close(s->listen_fd);
+        unlink(s->path);
+    }
+    s->wake_fd = s->epoll_fd = s->listen_fd = -1;
+    s->path = NULL;
+}
+
+#else
+
+bool stream_server_start(StreamServer *s, const char *path) {
+    memset(s, 0, sizeof(*s));
+    s->path = path;
+    TraceLog(LOG_WARNING, "STREAM: Band streaming needs Linux (epoll)");
+    return false;
+}
+
+void stream_server_publish(StreamServer *s, uint64_t frame, double time, const float levels[], size_t bands) {
+    (void) s;
+    (void) frame;
+    (void) time;
+    (void) levels;
+    (void) bands;
+}
+
+void stream_server_stop(StreamServer *s) {
+    (void) s;
+}
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef STREAM_SERVER_H
+#define STREAM_SERVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "stream_proto.h"
+
+// Records waiting between the analysis and the server thread, power of two.
+#define STREAM_RECORDS 16
+#define STREAM_MAX_SUBSCRIBERS 1024
+
+typedef struct {
+    int fd;
+    // tail of a record the socket only took part of; until it is flushed
+    // new frames are dropped for this subscriber
+    unsigned char pending[STREAM_MAX_RECORD];
+    size_t pending_size;
+    size_t pending_sent;
+    uint64_t dropped;
+} StreamSubscriber;
+
+typedef struct {
+    size_t size;
+    unsigned char data[STREAM_MAX_RECORD];
+} StreamRecord;
+
+// Fan-out of band frames over a Unix domain socket. The analysis thread
+// serialises each frame once into a slot of a single-producer ring and
+// wakes the server's epoll loop, which writes that same buffer to every
+// subscriber without blocking.
+typedef struct {
+    const char *path;
+    int listen_fd;
+    int epoll_fd;
+    int wake_fd;
+    pthread_t thread;
+    _Atomic bool running;
+
+    StreamRecord records[STREAM_RECORDS];
+    _Atomic size_t head;
+    _Atomic size_t tail;
+    _Atomic uint64_t dropped;
+
+    StreamSubscriber *subscribers;
+    size_t count;
+    uint64_t sent;
+} StreamServer;
+
+// Listens on path (removing a stale socket file). Linux only.
+bool stream_server_start(StreamServer *s, const char *path);
+// Never blocks, drops the frame when the server thread is behind.
+void stream_server_publish(StreamServer *s, uint64_t frame, double time, const float levels[], size_t bands);
+// Does nothing for a server that was never started or already stopped.
+void stream_server_stop(StreamServer *s);
+
+#endif // STREAM_SERVER_H
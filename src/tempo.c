@@ -0,0 +1,105 @@
+#include <string.h>
+#include <math.h>
+#include "tempo.h"
+
+#define ENV(t, i) ((t)->envelope[((t)->ticks - 1 - (i)) % TEMPO_HISTORY])
+
+void tempo_init(TempoTracker *t) {
+    memset(t, 0, sizeof(*t));
+    t->bpm = 120.0f;
+}
+
+// Comb over the running autocorrelation: a lag scores for itself and its
+// double, weighted towards moderate tempi so half/double picks are rare.
+static float comb(const TempoTracker *t, size_t lag) {
+    float bpm = 60.0f * TEMPO_RATE / lag;
+    float octaves = log2f(bpm / 120.0f);
+    float weight = expf(-0.5f * octaves * octaves);
+    return (t->acf[lag] + 0.5f * t->acf[2 * lag]) * weight;
+}
+
+static void estimate_tempo(TempoTracker *t) {
+    size_t best = TEMPO_MIN_LAG;
+    float best_score = -INFINITY;
+    for (size_t lag = TEMPO_MIN_LAG; lag <= TEMPO_MAX_LAG; ++lag) {
+        float score = comb(t, lag);
+        if (score > best_score) {
+            best_score = score;
+            best = lag;
+        }
+    }
+
+    // parabolic interpolation for a sub-tick period
+    float lag = best;
+    if (best > TEMPO_MIN_LAG && best < TEMPO_MAX_LAG) {
+        float a = comb(t, best - 1);
+        float c = comb(t, best + 1);
+        float d = a - 2 * best_score + c;
+        if (d < 0) lag += 0.5f * (a - c) / d;
+    }
+
+    float bpm = 60.0f * TEMPO_RATE / lag;
+    t->bpm += (bpm - t->bpm) * 0.1f;
+    t->confidence = t->acf[0] > 0 ? fminf(fmaxf(t->acf[best] / t->acf[0], 0.0f), 1.0f) : 0.0f;
+}
+
+// Aligns a pulse train with the beat period against the envelope and pulls
+// the free running phase towards the best alignment.
+static void track_phase(TempoTracker *t) {
+    float period = 60.0f * TEMPO_RATE / t->bpm;
+    t->phase += 1.0f / period;
+    t->phase -= floorf(t->phase);
+
+    size_t reach = (size_t) (period * (TEMPO_PHASE_BEATS - 1));
+    if (t->ticks < reach + (size_t) period + 2 || reach + (size_t) period + 2 >= TEMPO_HISTORY) return;
+
+    size_t best = 0;
+    float best_score = -INFINITY;
+    for (size_t offset = 0; offset < (size_t) period; ++offset) {
+        float score = 0.0f;
+        for (size_t k = 0; k < TEMPO_PHASE_BEATS; ++k) {
+            score += fmaxf(ENV(t, offset + (size_t) (k * period + 0.5f)), 0.0f);
+        }
+        if (score > best_score) {
+            best_score = score;
+            best = offset;
+        }
+    }
+
+    float error = best / period - t->phase;
+    error -= floorf(error + 0.5f);
+    t->phase += error * 0.1f;
+    t->phase -= floorf(t->phase);
+}
+
+static void tick(TempoTracker *t, float strength) {
+    t->mean += (strength - t->mean) * (1.0f / TEMPO_RATE);
+    float e = strength - t->mean;
+    t->envelope[t->ticks % TEMPO_HISTORY] = e;
+    t->ticks++;
+
+    // exponentially forgetting autocorrelation, a few seconds of memory
+    const float decay = 1.0f - 1.0f / (4 * TEMPO_RATE);
+    size_t lags = t->ticks < 2 * TEMPO_MAX_LAG + 1 ? t->ticks : 2 * TEMPO_MAX_LAG + 1;
+    for (size_t lag = 0; lag < lags; ++lag) {
+        t->acf[lag] = t->acf[lag] * decay + e * ENV(t, lag);
+    }
+
+    estimate_tempo(t);
+    track_phase(t);
+}
+
+void tempo_update(TempoTracker *t, float strength, double time) {
+    // a stalled frame must not cost more than one history of ticks
+    if (time - t->next_tick > (double) TEMPO_HISTORY / TEMPO_RATE) {
+        t->next_tick = time - (double) TEMPO_HISTORY / TEMPO_RATE;
+    }
+    while (t->next_tick <= time) {
+        tick(t, strength);
+        t->next_tick += 1.0 / TEMPO_RATE;
+    }
+}
+
+float tempo_pulse(const TempoTracker *t) {
+    return expf(-6.0f * t->phase) * t->confidence;
+}
@@ -0,0 +1,38 @@
+#ifndef TEMPO_H
+#define TEMPO_H
+
+#include <stddef.h>
+
+// The onset envelope is resampled to a fixed rate so tempo does not depend
+// on how often the analysis runs.
+#define TEMPO_RATE 100
+// Envelope ring length in ticks, must be a power of two.
+#define TEMPO_HISTORY 512
+#define TEMPO_MIN_BPM 60
+#define TEMPO_MAX_BPM 200
+#define TEMPO_MIN_LAG (TEMPO_RATE * 60 / TEMPO_MAX_BPM)
+#define TEMPO_MAX_LAG (TEMPO_RATE * 60 / TEMPO_MIN_BPM)
+// Beats the phase search looks back over.
+#define TEMPO_PHASE_BEATS 4
+
+typedef struct {
+    // latest estimate, read by the renderer and external consumers
+    float bpm;
+    float phase;      // 0 on the beat, rising to 1 just before the next one
+    float confidence; // 0..1
+
+    // state, all preallocated
+    float envelope[TEMPO_HISTORY];
+    float acf[2 * TEMPO_MAX_LAG + 1];
+    float mean;
+    size_t ticks;
+    double next_tick;
+} TempoTracker;
+
+void tempo_init(TempoTracker *t);
+// Feeds the onset strength of the analysis frame ending at time (seconds).
+void tempo_update(TempoTracker *t, float strength, double time);
+// 1 on the beat decaying towards 0, scaled by confidence.
+float tempo_pulse(const TempoTracker *t);
+
+#endif // TEMPO_H
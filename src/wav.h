@@ -0,0 +1,40 @@
+#ifndef WAV_H
+#define WAV_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Interleaved sample formats the readers convert to float.
+typedef enum {
+    PCM_U8,
+    PCM_S16,
+    PCM_S24,
+    PCM_S32,
+    PCM_F32,
+} PcmFormat;
+
+typedef struct {
+    unsigned int sample_rate;
+    unsigned int channels;
+    PcmFormat format;
+    size_t frame_size;    // bytes per interleaved frame
+    uint64_t data_offset; // from the start of the file
+    uint64_t frame_count;
+} WavInfo;
+
+// Parses the RIFF header at the start of a WAV file up to the data chunk,
+// which itself does not need to be in data. Plain and extensible PCM and
+// 32 bit float are understood.
+bool wav_parse(const unsigned char *data, size_t size, WavInfo *info);
+
+// Describes headerless interleaved PCM from "FORMAT:RATE:CHANNELS", where
+// FORMAT is u8, s16, s24, s32 or f32 (e.g. s16:48000:2). frame_count and
+// data_offset are left at 0.
+bool pcm_parse(const char *spec, WavInfo *info);
+
+size_t pcm_sample_size(PcmFormat format);
+// Converts count samples to float in -1..1. Native little-endian hosts.
+void pcm_to_float(const void *src, PcmFormat format, float *dst, size_t count);
+
+#endif // WAV_H
@@ -0,0 +1,112 @@
+// Writes the plan tables and Hann windows of power of two FFT sizes as a C
+// source (see src/fft_tables.h), run by the build so that plans of those
+// sizes cost nothing to make and share read-only pages.
+//
+//   fft_tables OUTPUT SIZE...
+//
+// Sizes that are not powers of two from 16 to 65536 are skipped, their
+// plans are computed at run time.
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "fft.h"
+
+#define MAX_SIZES 64
+
+static const FftKernel kernels[] = { FFT_RADIX2, FFT_RADIX4, FFT_SPLIT_RADIX };
+static const char *const kernel_names[] = { "FFT_RADIX2", "FFT_RADIX4", "FFT_SPLIT_RADIX" };
+
+// fft.c logs through raylib, which this tool does without
+void TraceLog(int level, const char *text, ...) {
+    va_list args;
+    va_start(args, text);
+    vfprintf(stderr, text, args);
+    va_end(args);
+    fputc('\n', stderr);
+    (void) level;
+}
+
+static bool write_size(FILE *f, size_t n) {
+    static float window[1 << 16];
+    FftPlan plan;
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k) {
+        if (!fft_plan_init(&plan, n, kernels[k])) return false;
+        fprintf(f, "static const float twiddles_%zu_%zu[][2] = {\n", k, n);
+        for (size_t i = 0; i < plan.twiddle_count; ++i) {
+            fprintf(f, "%s{ %.9g, %.9g },%s", i % 4 == 0 ? "    " : " ", crealf(plan.twiddles[i]),
+                    cimagf(plan.twiddles[i]), i % 4 == 3 || i + 1 == plan.twiddle_count ? "\n" : "");
+        }
+        fprintf(f, "};\n\n");
+        if (k + 1 == sizeof(kernels) / sizeof(kernels[0])) {
+            fprintf(f, "static const uint32_t reverse_%zu[] = {\n", n);
+            for (size_t i = 0; i < n; ++i) {
+                fprintf(f, "%s%u,%s", i % 12 == 0 ? "    " : " ", (unsigned int) plan.reverse[i],
+                        i % 12 == 11 || i + 1 == n ? "\n" : "");
+            }
+            fprintf(f, "};\n\n");
+        }
+        fft_plan_free(&plan);
+    }
+
+    const float *hann = fft_hann_window(n, window);
+    fprintf(f, "static const float hann_%zu[] = {\n", n);
+    for (size_t i = 0; i < n; ++i) {
+        fprintf(f, "%s%.9g,%s", i % 6 == 0 ? "    " : " ", hann[i], i % 6 == 5 || i + 1 == n ? "\n" : "");
+    }
+    fprintf(f, "};\n\n");
+    return true;
+}
+
+static bool write_lists(FILE *f, const size_t sizes[], size_t count) {
+    fprintf(f, "const FftTable fft_tables[] = {\n");
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k) {
+            FftPlan plan;
+            if (!fft_plan_init(&plan, sizes[i], kernels[k])) return false;
+            fprintf(f, "    { %zu, %s, twiddles_%zu_%zu, %zu, reverse_%zu },\n", sizes[i], kernel_names[k], k,
+                    sizes[i], plan.twiddle_count, sizes[i]);
+            fft_plan_free(&plan);
+        }
+    }
+    fprintf(f, "    { 0 },\n};\n\nconst FftWindowTable fft_window_tables[] = {\n");
+    for (size_t i = 0; i < count; ++i) fprintf(f, "    { %zu, hann_%zu },\n", sizes[i], sizes[i]);
+    fprintf(f, "    { 0 },\n};\n");
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s OUTPUT SIZE...\n", argv[0]);
+        return 1;
+    }
+    size_t sizes[MAX_SIZES];
+    size_t count = 0;
+    for (int i = 2; i < argc; ++i) {
+        size_t n = strtoul(argv[i], NULL, 10);
+        bool seen = false;
+        for (size_t j = 0; j < count; ++j) seen = seen || sizes[j] == n;
+        if (seen || n < 16 || n > (1 << 16) || (n & (n - 1)) != 0 || count == MAX_SIZES) continue;
+        sizes[count++] = n;
+    }
+
+    FILE *f = fopen(argv[1], "w");
+    if (f == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+    fprintf(f, "// Generated by tools/fft_tables.c, do not edit.\n#include \"fft_tables.h\"\n\n");
+    bool ok = true;
+    for (size_t i = 0; ok && i < count; ++i) ok = write_size(f, sizes[i]);
+    ok = ok && write_lists(f, sizes, count);
+    ok = !ferror(f) && ok;
+    if (fclose(f) != 0) {
+        perror(argv[1]);
+        ok = false;
+    }
+    // a partial file would pass for up to date on the next build
+    if (!ok) {
+        remove(argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+// Prints the OSC bundles --osc sends, for checking the output without
+// lighting or VJ software.
+//
+//   osc_dump [PORT] [COUNT]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+static uint32_t get_u32(const unsigned char *p) {
+    return (uint32_t) p[0] << 24 | (uint32_t) p[1] << 16 | (uint32_t) p[2] << 8 | p[3];
+}
+
+static size_t padded(size_t n) {
+    return (n + 4) & ~(size_t) 3;
+}
+
+static void dump_message(const unsigned char *p, size_t size) {
+    const char *address = (const char *) p;
+    size_t offset = padded(strnlen(address, size));
+    if (offset >= size || p[offset] != ',') {
+        printf("  malformed message\n");
+        return;
+    }
+    const char *tags = (const char *) p + offset + 1;
+    size_t count = strnlen(tags, size - offset - 1);
+    offset += padded(count + 1);
+
+    printf("  %s", address);
+    for (size_t i = 0; i < count && offset + 4 <= size; ++i) {
+        if (i == 8) {
+            printf(" ... (%zu values)", count);
+            break;
+        }
+        uint32_t v = get_u32(p + offset);
+        switch (tags[i]) {
+            case 'f': {
+                float f;
+                memcpy(&f, &v, 4);
+                printf(" %.3f", f);
+                offset += 4;
+                break;
+            }
+            case 'i':
+                printf(" %d", (int32_t) v);
+                offset += 4;
+                break;
+            case 'd': {
+                uint64_t u = (uint64_t) v << 32 | get_u32(p + offset + 4);
+                double d;
+                memcpy(&d, &u, 8);
+                printf(" %.3f", d);
+                offset += 8;
+                break;
+            }
+            default:
+                printf(" ?%c", tags[i]);
+                i = count;
+                break;
+        }
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    int port = argc > 1 ? atoi(argv[1]) : 9000;
+    long limit = argc > 2 ? atol(argv[2]) : -1;
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr = {
+            .sin_family = AF_INET,
+            .sin_port = htons(port),
+            .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    if (fd < 0 || bind(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+        perror("bind");
+        return 1;
+    }
+
+    static unsigned char packet[65536];
+    for (long n = 0; limit < 0 || n < limit; ++n) {
+        ssize_t size = recv(fd, packet, sizeof(packet), 0);
+        if (size < 16 || memcmp(packet, "#bundle", 8) != 0) {
+            printf("not a bundle (%zd bytes)\n", size);
+            continue;
+        }
+        printf("bundle, %zd bytes\n", size);
+        for (size_t offset = 16; offset + 4 <= (size_t) size;) {
+            uint32_t length = get_u32(packet + offset);
+            offset += 4;
+            if (offset + length > (size_t) size) break;
+            dump_message(packet + offset, length);
+            offset += length;
+        }
+    }
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,48 @@
+// Converts a --spectrogram file to CSV, one row per analysis frame, for
+// looking at it in a spreadsheet or plotting script.
+//
+//   spectrogram_csv FILE [FROM [TO]]
+//
+// FROM and TO are in seconds; only the frames in between are touched.
+#include <stdio.h>
+#include <stdlib.h>
+#include "spectrogram.h"
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 4) {
+        fprintf(stderr, "usage: %s FILE [FROM [TO]]\n", argv[0]);
+        return 1;
+    }
+    Spectrogram s;
+    if (!spectrogram_open(&s, argv[1])) {
+        fprintf(stderr, "%s: not a spectrogram file\n", argv[1]);
+        return 1;
+    }
+    const SpectrogramHeader *h = s.header;
+    fprintf(stderr, "%s: %u Hz, FFT %u, %u bands, %u frames/s, %zu frames%s\n", argv[1], h->sample_rate,
+            h->fft_size, h->bands, h->frame_rate, s.count, s.index != NULL ? "" : " (unfinished)");
+    if (s.count == 0) {
+        spectrogram_close(&s);
+        return 0;
+    }
+
+    size_t first = argc > 2 ? spectrogram_find(&s, atof(argv[2])) : 0;
+    size_t last = argc > 3 ? spectrogram_find(&s, atof(argv[3])) : s.count - 1;
+
+    // bands are named by their lower edge in Hz
+    printf("time,flux,onset_band,f0,confidence");
+    static const char *classes[12] = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
+    for (size_t i = 0; i < 12; ++i) printf(",chroma_%s", classes[i]);
+    for (size_t i = 0; i < h->bands; ++i) printf(",%.1f", (double) s.band_edge[i] * h->sample_rate / h->fft_size);
+    printf("\n");
+
+    for (size_t i = first; i <= last; ++i) {
+        const SpectrogramFrame *f = spectrogram_frame(&s, i);
+        printf("%.6f,%g,%u,%g,%g", f->time, f->flux, f->onset_band, f->f0, f->confidence);
+        for (size_t c = 0; c < 12; ++c) printf(",%g", f->chroma[c]);
+        for (size_t b = 0; b < h->bands; ++b) printf(",%g", f->levels[b]);
+        printf("\n");
+    }
+    spectrogram_close(&s);
+    return 0;
+}
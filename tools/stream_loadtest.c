@@ -0,0 +1,135 @@
+// Load test for --stream: connects many subscribers to a running
+// spectralizer and reports how much of the fan-out reaches them.
+//
+//   stream_loadtest SOCKET [SUBSCRIBERS] [SECONDS] [SLOW]
+//
+// The first SLOW subscribers never read, to check they only cost
+// themselves frames.
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "stream_proto.h"
+
+typedef struct {
+    int fd;
+    unsigned char buffer[4 * STREAM_MAX_RECORD];
+    size_t fill;
+    uint64_t next_frame;
+    uint64_t records;
+    uint64_t gaps;
+    uint64_t bytes;
+} Subscriber;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int connect_to(const char *path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Consumes every complete record in the subscriber's buffer.
+static int parse(Subscriber *sub) {
+    size_t offset = 0;
+    while (sub->fill - offset >= sizeof(StreamRecordHeader)) {
+        StreamRecordHeader header;
+        memcpy(&header, sub->buffer + offset, sizeof(header));
+        if (header.magic != STREAM_MAGIC || header.version != STREAM_VERSION || header.size > STREAM_MAX_RECORD) {
+            return -1;
+        }
+        if (sub->fill - offset < header.size) break;
+
+        if (sub->records > 0 && header.frame != sub->next_frame) sub->gaps += header.frame - sub->next_frame;
+        sub->next_frame = header.frame + 1;
+        sub->records++;
+        offset += header.size;
+    }
+    memmove(sub->buffer, sub->buffer + offset, sub->fill - offset);
+    sub->fill -= offset;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s SOCKET [SUBSCRIBERS] [SECONDS] [SLOW]\n", argv[0]);
+        return 1;
+    }
+    const char *path = argv[1];
+    int count = argc > 2 ? atoi(argv[2]) : 200;
+    double seconds = argc > 3 ? atof(argv[3]) : 10.0;
+    int slow = argc > 4 ? atoi(argv[4]) : 0;
+    if (count <= 0 || slow < 0 || slow > count) return 1;
+
+    Subscriber *subs = calloc(count, sizeof(Subscriber));
+    int epoll_fd = epoll_create1(0);
+    for (int i = 0; i < count; ++i) {
+        subs[i].fd = connect_to(path);
+        if (subs[i].fd < 0) {
+            fprintf(stderr, "connect %d to %s failed: %s\n", i, path, strerror(errno));
+            return 1;
+        }
+        if (i < slow) continue;
+        struct epoll_event ev = { .events = EPOLLIN, .data.u32 = (uint32_t) i };
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, subs[i].fd, &ev);
+    }
+
+    double start = now();
+    struct epoll_event events[256];
+    while (now() - start < seconds) {
+        int n = epoll_wait(epoll_fd, events, 256, 100);
+        for (int e = 0; e < n; ++e) {
+            Subscriber *sub = &subs[events[e].data.u32];
+            ssize_t got = recv(sub->fd, sub->buffer + sub->fill, sizeof(sub->buffer) - sub->fill, 0);
+            if (got <= 0) {
+                fprintf(stderr, "subscriber %u disconnected\n", events[e].data.u32);
+                epoll_ctl(epoll_fd, EPOLL_CTL_DEL, sub->fd, NULL);
+                continue;
+            }
+            sub->fill += got;
+            sub->bytes += got;
+            if (parse(sub) != 0) {
+                fprintf(stderr, "subscriber %u got a malformed record\n", events[e].data.u32);
+                return 1;
+            }
+        }
+    }
+    double elapsed = now() - start;
+
+    uint64_t records = 0;
+    uint64_t gaps = 0;
+    uint64_t bytes = 0;
+    uint64_t min = UINT64_MAX;
+    for (int i = slow; i < count; ++i) {
+        records += subs[i].records;
+        gaps += subs[i].gaps;
+        bytes += subs[i].bytes;
+        if (subs[i].records < min) min = subs[i].records;
+    }
+    int readers = count - slow;
+    printf("subscribers      %d (%d not reading)\n", count, slow);
+    printf("records          %llu, %.0f/s total, %.1f/s per subscriber, min %llu\n",
+           (unsigned long long) records, records / elapsed, readers ? records / elapsed / readers : 0.0,
+           (unsigned long long) (readers ? min : 0));
+    printf("throughput       %.2f MB/s\n", bytes / elapsed / 1e6);
+    printf("dropped frames   %llu (%.2f%%)\n", (unsigned long long) gaps,
+           records + gaps ? 100.0 * gaps / (records + gaps) : 0.0);
+
+    for (int i = 0; i < count; ++i) close(subs[i].fd);
+    free(subs);
+    return 0;
+}